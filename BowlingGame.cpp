@@ -1,13 +1,84 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <cstring>
+#include <deque>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __linux__
+#include <pthread.h>
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRC32C_HARDWARE
+#include <nmmintrin.h>
+#endif
+#ifdef BENCHMARK
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <regex>
+#include <set>
+#include <string>
+#endif
 
 constexpr uint8_t PINS {10}; // Number of pins per frame
 constexpr uint8_t FRAMES {10}; // Number of frames
 constexpr uint8_t BASE_SCORE {10}; // Base score for strike and spare
+constexpr uint16_t MAX_SCORE {300}; // Score of a perfect game
+constexpr uint8_t SERIES_GAMES {3}; // Games in a series
+constexpr uint8_t MAX_ROLLS {2 * FRAMES + 1}; // Most rolls a game can have
+constexpr uint16_t FRAME_CODES {(PINS + 1) * (PINS + 1) * (PINS + 1)}; // Number of (roll, next, next) codes
+
+/**
+ * @brief Packs a frame's first roll and the two rolls following it into a table index
+ */
+constexpr uint16_t frameCode(uint8_t r1, uint8_t r2, uint8_t r3) {
+	return (r1 * (PINS + 1) + r2) * (PINS + 1) + r3;
+}
+
+/**
+ * @brief Builds the full score (including bonus) of frames 1-9 for every frameCode()
+ *        e.g. strike  10 + next two rolls
+ *             spare   10 + next roll
+ *             normal  both rolls
+ */
+constexpr std::array<uint8_t, FRAME_CODES> buildFrameScoreTable() {
+	std::array<uint8_t, FRAME_CODES> table {};
+	for (uint8_t r1 = 0; r1 <= PINS; r1++) {
+		for (uint8_t r2 = 0; r2 <= PINS; r2++) {
+			for (uint8_t r3 = 0; r3 <= PINS; r3++) {
+				uint8_t score = r1 + r2;
+				if (r1 == BASE_SCORE) {
+					score = BASE_SCORE + r2 + r3;
+				} else if (r1 + r2 == BASE_SCORE) {
+					score = BASE_SCORE + r3;
+				}
+				table[frameCode(r1, r2, r3)] = score;
+			}
+		}
+	}
+	return table;
+}
+
+constexpr std::array<uint8_t, FRAME_CODES> FRAME_SCORE_TABLE = buildFrameScoreTable();
 
 /**
  * @class Roll
@@ -176,180 +247,4493 @@ public:
 
 
 /**
- * @class BowlingGame
- * @brief Simulates the bowling game and calculates scores
+ * @brief Scoring status of a frame, as a scoreboard shows it
+ *        Values up to PendingTwoBalls are the number of balls still needed to settle the score
  */
-class BowlingGame {
-public:
-	void roll(uint8_t pins) {
-		m_rolls.push_back(pins);
+enum class FrameStatus : uint8_t {
+	Final = 0, // Score will not change any more
+	PendingOneBall = 1, // Waiting for one more ball (spare bonus, strike half way, open frame half way)
+	PendingTwoBalls = 2, // Waiting for two more balls (strike bonus)
+	NotStarted = 3 // No ball rolled in this frame yet
+};
+
+/**
+ * @brief Running score and best reachable score for every possible next ball
+ */
+struct NextBallOutcomes {
+	uint8_t count {0}; // Valid entries, for pins 0 .. count - 1
+	std::array<uint16_t, PINS + 1> runningScore {};
+	std::array<uint16_t, PINS + 1> maxPossible {};
+};
+
+/**
+ * @brief Board after a roll in 4 bytes, compact enough to keep for every roll of a game:
+ *        ScoreState::futureKey() (frame, ball, pins standing, pending bonuses of the
+ *        current and two previous frames) in the low half, running total in the high half.
+ *        Frame scores are not repeated per roll: a frame's score never changes once status()
+ *        says Final, so the latest ScoreState has it for every earlier roll.
+ */
+struct BoardCheckpoint {
+	uint32_t bits {PINS << 6}; // Empty board
+
+	uint16_t total() const {
+		return bits >> 16;
 	}
 
-	void processFrames() {
-		m_frames.clear();
-		size_t i = 0;
+	/**
+	 * @brief Index of the frame the next roll belongs to, FRAMES once complete
+	 */
+	uint8_t frame() const {
+		return bits & 0xf;
+	}
 
-		while (m_frames.size() < FRAMES - 1 && i < m_rolls.size()) {
-			uint8_t r1 = m_rolls[i++];
-			uint8_t r2 = (r1 != PINS && i < m_rolls.size()) ? m_rolls[i++] : 0;
-			m_frames.push_back(FrameFactory::createFrame(m_frames.size(), r1, r2));
-		}
+	bool complete() const {
+		return frame() == FRAMES;
+	}
 
-		// 10th frame
-		if (i < m_rolls.size()) {
-			uint8_t r1 = m_rolls[i++];
-			uint8_t r2 = (i < m_rolls.size()) ? m_rolls[i++] : 0;
-			uint8_t r3 = (i < m_rolls.size() && (r1 == PINS || r1 + r2 == PINS)) ? m_rolls[i++] : 0;
-			m_frames.push_back(FrameFactory::createFrame(FRAMES - 1, r1, r2, r3));
+	int pinsStanding() const {
+		return complete() ? -1 : bits >> 6 & 0xf;
+	}
+
+	FrameStatus status(uint8_t frame) const {
+		uint8_t current = this->frame(), ball = bits >> 4 & 3;
+		if (complete() || frame + 2 < current) {
+			return FrameStatus::Final;
+		}
+		if (frame > current || (frame == current && ball == 0)) {
+			return FrameStatus::NotStarted;
 		}
+		return static_cast<FrameStatus>(bits >> (10 + 2 * (current - frame)) & 3);
 	}
+};
 
+/**
+ * @class ScoreState
+ * @brief Incremental scoring state of a game, updated in O(1) per roll.
+ *        Unknown bonus balls are counted as 0, like BowlingGame::calculateScore,
+ *        and status() tells which frame scores are still provisional.
+ */
+class ScoreState {
+public:
+	/**
+	 * @brief Applies one roll, the caller checks it against pinsStanding()
+	 */
+	void apply(uint8_t pins) {
+		if (complete()) {
+			return;
+		}
 
-	void displayBoard() {
-		std::cout << "\nFrame |";
-		for (size_t i = 1; i <= FRAMES; i++) {
-			std::cout << " " << std::setw(4) << i << " |";
+		// Bonus for a strike or spare in the previous two frames
+		for (uint8_t f = m_frame >= 2 ? m_frame - 2 : 0; f < m_frame; f++) {
+			if (need(f) > 0) {
+				m_frameScores[f] += pins;
+				m_total += pins;
+				setNeed(f, need(f) - 1);
+			}
 		}
-		std::cout << "\n-----------------------------------------------------------------------------\n";
+		m_frameScores[m_frame] += pins;
+		m_total += pins;
 
-		std::cout << "Rolls |";
-		for (const auto& frame : m_frames) {
-			std::cout << " " << std::setw(4) << frame->frameType() << " |";
+		bool cleared = pins == m_standing;
+		if (m_frame < FRAMES - 1) {
+			setNeed(m_frame, cleared ? (m_ball == 0 ? 2 : 1) : (m_ball == 0 ? 1 : 0));
+			if (cleared || m_ball == 1) {
+				m_frame++;
+				m_ball = 0;
+				m_standing = PINS;
+				return;
+			}
+			m_ball++;
+			m_standing -= pins;
+			return;
 		}
-		std::cout << "\n-----------------------------------------------------------------------------\n";
 
-		std::cout << "Score |";
-		uint16_t runningScore = 0;
-		for (size_t i = 0; i < m_scores.size(); i++) {
-			runningScore = m_scores[i];
-			std::cout << " " << std::setw(4) << runningScore << " |";
+		// 10th frame: a strike or spare earns the third ball, pins are reset when cleared
+		bool firstWasStrike = need(m_frame) == 2;
+		m_ball++;
+		if (m_ball == 1) {
+			setNeed(m_frame, cleared ? 2 : 1);
+		} else {
+			setNeed(m_frame, (m_ball == 2 && (firstWasStrike || cleared)) ? 1 : 0);
+		}
+		m_standing = cleared ? PINS : m_standing - pins;
+		if (need(m_frame) == 0) {
+			m_frame = FRAMES;
+			m_standing = 0;
 		}
-		std::cout << "\n";
 	}
 
-	int calculateScore() {
+	bool complete() const {
+		return m_frame == FRAMES;
+	}
 
-		int totalScore = 0;
-		size_t rollIndex = 0;
-		m_scores.clear();
+	/**
+	 * @brief Most pins the next roll can knock down, or -1 once the game is complete
+	 */
+	int pinsStanding() const {
+		return complete() ? -1 : m_standing;
+	}
 
-		for (size_t i = 0; i < m_frames.size(); i++) {
-			int frameScore = m_frames[i]->score();
+	uint16_t total() const {
+		return m_total;
+	}
 
-			if (i < FRAMES - 1) { // First 9 frames need bonus calculations
-				if (m_frames[i]->isStrike()) {
-					frameScore += strikeBonus(rollIndex);
-				} else if (m_frames[i]->isSpare()) {
-					frameScore += spareBonus(rollIndex);
-				}
-			}
+	/**
+	 * @brief Index of the frame the next roll belongs to, FRAMES once complete
+	 */
+	uint8_t frame() const {
+		return m_frame;
+	}
 
-			totalScore += frameScore;
-			m_scores.push_back(totalScore);
-			rollIndex += m_frames[i]->isStrike() ? 1 : 2; // Move index correctly
+	FrameStatus status(uint8_t frame) const {
+		if (frame > m_frame || (frame == m_frame && m_ball == 0)) {
+			return FrameStatus::NotStarted;
 		}
+		return static_cast<FrameStatus>(need(frame));
+	}
 
-		return totalScore;
+	/**
+	 * @brief Best total still reachable, i.e. the total if every remaining ball clears the deck
+	 */
+	uint16_t maxPossible() const {
+		ScoreState best = *this;
+		while (!best.complete()) {
+			best.apply(best.m_standing);
+		}
+		return best.m_total;
+	}
+
+	/**
+	 * @brief Evaluates every possible next ball with two playouts.
+	 *        The running score is affine in the pins (each pin counts once plus once per
+	 *        pending bonus), so it is filled by a single vectorizable loop. So is the best
+	 *        reachable score for every ball short of clearing the deck: the best game then
+	 *        picks up the remaining pins with the following ball (if the frame goes on)
+	 *        and continues the same way whatever the pins. Only the ball that clears the
+	 *        deck gets its own playout, besides the gutter ball anchoring the line.
+	 */
+	NextBallOutcomes nextBallOutcomes() const {
+		NextBallOutcomes outcomes;
+		if (complete()) {
+			return outcomes;
+		}
+		outcomes.count = m_standing + 1;
+
+		uint16_t weight = ballWeight();
+		for (uint8_t pins = 0; pins <= PINS; pins++) {
+			outcomes.runningScore[pins] = m_total + pins * weight;
+		}
+
+		ScoreState gutter = *this, cleared = *this;
+		gutter.apply(0);
+		cleared.apply(m_standing);
+		bool frameGoesOn = !gutter.complete() && gutter.m_frame == m_frame;
+		uint16_t slope = weight - (frameGoesOn ? gutter.ballWeight() : 0);
+		uint16_t base = gutter.maxPossible();
+		for (uint8_t pins = 0; pins < m_standing; pins++) {
+			outcomes.maxPossible[pins] = base + pins * slope;
+		}
+		outcomes.maxPossible[m_standing] = cleared.maxPossible();
+		return outcomes;
+	}
+
+	/**
+	 * @brief Packs everything the rest of the game depends on (frame, ball, pins standing,
+	 *        pending bonuses), so states with the same future share one key
+	 */
+	uint16_t futureKey() const {
+		if (complete()) {
+			return FRAMES;
+		}
+		uint8_t previous = m_frame >= 1 ? need(m_frame - 1) : 0;
+		uint8_t beforePrevious = m_frame >= 2 ? need(m_frame - 2) : 0;
+		return m_frame | m_ball << 4 | m_standing << 6 | need(m_frame) << 10 | previous << 12 | beforePrevious << 14;
+	}
+
+	BoardCheckpoint checkpoint() const {
+		return {static_cast<uint32_t>(m_total) << 16 | futureKey()};
+	}
+
+	/**
+	 * @brief Score of a single frame so far, bonus included
+	 */
+	uint8_t frameScore(uint8_t frame) const {
+		return m_frameScores[frame];
 	}
 
+	/**
+	 * @brief Cumulative score up to and including a frame, as shown on the board
+	 */
+	uint16_t runningScore(uint8_t frame) const {
+		uint16_t score = 0;
+		for (uint8_t f = 0; f <= frame; f++) {
+			score += m_frameScores[f];
+		}
+		return score;
+	}
 
 private:
-	std::vector<uint8_t> m_rolls;
-	std::vector<uint16_t> m_scores;
-	std::vector<std::unique_ptr<Frame>> m_frames;
+	uint32_t m_needs {0}; // Balls each frame still waits for, 2 bits per frame
+	std::array<uint8_t, FRAMES> m_frameScores {};
+	uint16_t m_total {0};
+	uint8_t m_frame {0};
+	uint8_t m_ball {0}; // Balls already rolled in the current frame
+	uint8_t m_standing {PINS};
 
-	uint8_t strikeBonus(int index) {
-		if (index + 1 < m_rolls.size()) {
-			uint8_t bonus = m_rolls[index + 1]; // First bonus roll
-			if (index + 2 < m_rolls.size()) {
-				bonus += m_rolls[index + 2]; // Second bonus roll
-			}
-			return bonus;
+	uint8_t need(uint8_t frame) const {
+		return (m_needs >> (2 * frame)) & 3;
+	}
+
+	/**
+	 * @brief Times each pin of the next ball counts: once, plus once per pending bonus
+	 */
+	uint16_t ballWeight() const {
+		uint16_t weight = 1;
+		for (uint8_t f = m_frame >= 2 ? m_frame - 2 : 0; f < m_frame; f++) {
+			weight += need(f) > 0;
 		}
-		return 0;
+		return weight;
 	}
-	uint8_t spareBonus(int index) {
-		if (index + 2 < m_rolls.size()) {
-			return m_rolls[index + 2]; // next roll after the spare
+
+	void setNeed(uint8_t frame, uint8_t balls) {
+		m_needs = (m_needs & ~(3u << (2 * frame))) | (static_cast<uint32_t>(balls) << (2 * frame));
+	}
+};
+
+/**
+ * @class GameBranch
+ * @brief Fixed-size, copyable game for what-if scenarios. A fork is a plain copy of
+ *        ~44 bytes (rolls plus ScoreState), cheaper than sharing a prefix would be.
+ */
+class GameBranch {
+public:
+	GameBranch() = default;
+
+	/**
+	 * @brief Records a roll, same validation as BowlingGame::roll
+	 */
+	bool roll(uint8_t pins) {
+		if (pins > m_state.pinsStanding()) {
+			return false;
 		}
-		return 0;
+		m_rolls[m_count++] = pins;
+		m_state.apply(pins);
+		return true;
+	}
+
+	GameBranch fork() const {
+		return *this;
+	}
+
+	const ScoreState &state() const {
+		return m_state;
+	}
+
+	int total() const {
+		return m_state.total();
+	}
+
+	size_t rollCount() const {
+		return m_count;
+	}
+
+	uint8_t rollAt(size_t index) const {
+		return m_rolls[index];
 	}
 
+private:
+	friend class BowlingGame;
+
+	std::array<uint8_t, MAX_ROLLS> m_rolls {};
+	uint8_t m_count {0};
+	ScoreState m_state;
+
+	/**
+	 * @brief Adopts a game's rolls with the state they led to, for BowlingGame::fork(),
+	 *        which only ever passes legal rolls and their own state
+	 */
+	GameBranch(const std::vector<uint8_t> &rolls, const ScoreState &state) : m_state(state) {
+		std::copy(rolls.begin(), rolls.end(), m_rolls.begin());
+		m_count = rolls.size();
+	}
 };
 
+
 /**
- * @brief Helper function to validate user input
+ * @brief Structure-of-arrays batch of games: rolls at a fixed MAX_ROLLS stride
+ *        (unused slots 0) next to one column per game attribute
  */
-uint8_t getValidatedInput(const std::string &prompt) {
-	int pins;
-	while (true) {
-		std::cout << prompt;
-		std::cin >> pins;
+struct GameColumns {
+	std::vector<uint8_t> rolls;
+	std::vector<uint8_t> rollCounts;
+	std::vector<uint16_t> totals;
 
-		if (std::cin.fail() || pins < 0 || pins > PINS) {
-			std::cin.clear();
-			std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-			std::cerr << "Invalid input! Enter a number between 0 and 10.\n";
-		} else {
-			return static_cast<uint8_t>(pins);
+	size_t size() const {
+		return totals.size();
+	}
+
+	void resize(size_t games) {
+		rolls.assign(games * MAX_ROLLS, 0);
+		rollCounts.assign(games, 0);
+		totals.assign(games, 0);
+	}
+
+	void store(size_t index, const GameBranch &game) {
+		for (size_t r = 0; r < game.rollCount(); r++) {
+			rolls[index * MAX_ROLLS + r] = game.rollAt(r);
 		}
+		rollCounts[index] = game.rollCount();
+		totals[index] = game.total();
 	}
+
+	GameBranch game(size_t index) const {
+		GameBranch branch;
+		for (size_t r = 0; r < rollCounts[index]; r++) {
+			branch.roll(rolls[index * MAX_ROLLS + r]);
+		}
+		return branch;
+	}
+};
+
+/**
+ * @brief Multiply-xorshift mixing (murmur3 finalizer), spreads keys whose low bits are regular
+ */
+constexpr uint64_t mixHash(uint64_t x) {
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdull;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ull;
+	return x ^ (x >> 33);
 }
 
 /**
- * @brief Process user input for the bowling game.
+ * @brief Runs work(t) for t = 0 .. threads - 1, each on its own thread, and waits for all of them
  */
-void processUserInput(BowlingGame &game) {
-	uint8_t frameCount = 0;
+template <typename Work>
+void parallelFor(unsigned threads, Work work) {
+	std::vector<std::thread> pool;
+	for (unsigned t = 0; t < threads; t++) {
+		pool.emplace_back(work, t);
+	}
+	for (auto &thread : pool) {
+		thread.join();
+	}
+}
 
-	while (frameCount < FRAMES) {
-		std::cout << "-----> Roll for frame " << static_cast<int>(frameCount + 1) << std::endl;
+/**
+ * @brief Aggregate of game totals with exact percentiles. Small groups keep their raw
+ *        totals; past SPARSE_GAMES games, when that would outgrow it, they switch to a
+ *        301-bin histogram, which lets partial aggregates merge by plain addition.
+ */
+struct ScoreStats {
+	static constexpr size_t SPARSE_GAMES {(MAX_SCORE + 1) * sizeof(uint32_t) / sizeof(uint16_t)};
 
-		uint8_t firstRoll = getValidatedInput("Enter Roll 1: ");
-		game.roll(firstRoll);
+	uint64_t count {0};
+	uint64_t sum {0};
+	uint16_t min {MAX_SCORE};
+	uint16_t max {0};
+	std::vector<uint16_t> totals; // Raw totals, until the histogram is allocated
+	std::vector<uint32_t> histogram; // Empty, or MAX_SCORE + 1 bins holding every game
 
-		if (frameCount == FRAMES - 1) {  // 10th frame logic
-			std::string prompt = (firstRoll == PINS) ? "Enter Extra Roll: " : "Enter Roll 2: ";
-			uint8_t secondRoll;
-			secondRoll = getValidatedInput(prompt);
-			game.roll(secondRoll);
+	void add(uint16_t total) {
+		count++;
+		sum += total;
+		min = std::min(min, total);
+		max = std::max(max, total);
+		if (histogram.empty() && count > SPARSE_GAMES) {
+			densify();
+		}
+		if (histogram.empty()) {
+			totals.push_back(total);
+		} else {
+			histogram[total]++;
+		}
+	}
+
+	void merge(const ScoreStats &other) {
+		count += other.count;
+		sum += other.sum;
+		min = std::min(min, other.min);
+		max = std::max(max, other.max);
+		if (histogram.empty() && (count > SPARSE_GAMES || !other.histogram.empty())) {
+			densify();
+		}
+		if (histogram.empty()) {
+			totals.insert(totals.end(), other.totals.begin(), other.totals.end());
+			return;
+		}
+		for (uint16_t total : other.totals) {
+			histogram[total]++;
+		}
+		for (size_t score = 0; score < other.histogram.size(); score++) {
+			histogram[score] += other.histogram[score];
+		}
+	}
 
+	double average() const {
+		return count == 0 ? 0 : static_cast<double>(sum) / count;
+	}
 
-			if (firstRoll == PINS || firstRoll + secondRoll == PINS) {  // Strike or Spare
-				uint8_t thirdRoll = getValidatedInput("Enter Extra Roll: ");
-				game.roll(thirdRoll);
+	/**
+	 * @brief Smallest score at or below which `percent` of the games fall
+	 */
+	uint16_t percentile(double percent) const {
+		uint64_t rank = std::max<uint64_t>(1, std::ceil(percent / 100 * count));
+		if (histogram.empty()) {
+			if (totals.empty()) {
+				return max;
 			}
-			return;
+			std::vector<uint16_t> sorted = totals;
+			auto nth = sorted.begin() + std::min<uint64_t>(rank, sorted.size()) - 1;
+			std::nth_element(sorted.begin(), nth, sorted.end());
+			return *nth;
 		}
+		uint64_t seen = 0;
+		for (uint16_t score = 0; score <= MAX_SCORE; score++) {
+			seen += histogram[score];
+			if (seen >= rank) {
+				return score;
+			}
+		}
+		return max;
+	}
 
-		if (firstRoll == PINS) {  // Strike, move to next frame
-			frameCount++;
-			continue;
+private:
+	void densify() {
+		histogram.assign(MAX_SCORE + 1, 0);
+		for (uint16_t total : totals) {
+			histogram[total]++;
 		}
+		totals = std::vector<uint16_t>();
+	}
+};
 
-		uint8_t secondRoll = getValidatedInput("Enter Roll 2: ");
-		game.roll(secondRoll);
+/**
+ * @brief Groups game totals by a key column (lane, center, league, week, or several packed
+ *        into one 64-bit key) and aggregates each group.
+ *        Each thread aggregates a slice into partials already split by key hash, then each
+ *        thread merges one hash partition from every slice, so no step takes a lock.
+ * @return no groups if keys and totals differ in length
+ */
+std::unordered_map<uint64_t, ScoreStats> groupScores(const std::vector<uint64_t> &keys,
+		const std::vector<uint16_t> &totals, unsigned threads) {
+	if (keys.size() != totals.size()) {
+		return {};
+	}
+	threads = std::max(1u, threads);
+	using Partition = std::unordered_map<uint64_t, ScoreStats>;
+	std::vector<std::vector<Partition>> partials(threads, std::vector<Partition>(threads));
+	std::vector<Partition> merged(threads);
 
-		frameCount++;
+	parallelFor(threads, [&](unsigned t) {
+		ScoreStats *last = nullptr;
+		uint64_t lastKey = 0;
+		for (size_t g = totals.size() * t / threads; g < totals.size() * (t + 1) / threads; g++) {
+			if (!last || keys[g] != lastKey) { // Archives are mostly ordered, so keys come in runs
+				lastKey = keys[g];
+				last = &partials[t][mixHash(lastKey) % threads][lastKey];
+			}
+			last->add(totals[g]);
+		}
+	});
+	parallelFor(threads, [&](unsigned p) {
+		for (unsigned t = 0; t < threads; t++) {
+			for (const auto &[key, stats] : partials[t][p]) {
+				merged[p][key].merge(stats);
+			}
+		}
+	});
+
+	Partition groups;
+	for (auto &partition : merged) {
+		groups.merge(partition);
 	}
+	return groups;
 }
 
 
-int main() {
+/**
+ * @brief A game found by similarity search and its distance to the query
+ */
+struct SimilarGame {
+	size_t game;
+	uint32_t distance;
+};
 
-	BowlingGame game;
-#ifdef USER_DRIVEN
-	processUserInput(game);
-#else
-	std::vector<uint8_t> rolls {1, 4, 4, 5, 6, 4, 5, 5, 10, 0, 1, 7, 3, 6, 4, 10, 2, 8, 6};
-	for(auto r : rolls) {
-		game.roll(r);
+/**
+ * @class SimilarGames
+ * @brief Exact nearest-neighbour search over an archive, by
+ *        FrameScoreL1  sum of per-frame score differences (16-byte vectors, one SAD per game)
+ *        RollHamming   number of roll slots that differ in the packed roll rows
+ *        Brute force on every core with a top-K heap per thread.
+ */
+class SimilarGames {
+public:
+	enum class Metric {
+		FrameScoreL1,
+		RollHamming
+	};
+
+	/**
+	 * @brief Precomputes the per-frame score vector of every game and copies the roll rows,
+	 *        so `games` need not outlive the index
+	 */
+	explicit SimilarGames(const GameColumns &games) : m_rolls(games.rolls), m_frameScores(games.size()) {
+		for (size_t g = 0; g < games.size(); g++) {
+			m_frameScores[g] = frameScores(games.game(g));
+		}
 	}
-#endif
-	game.processFrames();
-	int totalSocre = game.calculateScore();
-	game.displayBoard();
 
-	std::cout << "Total score: " << totalSocre << std::endl;
-	return 0;
-}
\ No newline at end of file
+	std::vector<SimilarGame> nearest(const GameBranch &query, size_t k, Metric metric, unsigned threads) const {
+		threads = std::max(1u, threads);
+		FrameVector queryScores = frameScores(query);
+		std::array<uint8_t, MAX_ROLLS> queryRolls {};
+		for (size_t r = 0; r < query.rollCount(); r++) {
+			queryRolls[r] = query.rollAt(r);
+		}
+
+		auto closer = [](const SimilarGame &a, const SimilarGame &b) {
+			return a.distance != b.distance ? a.distance < b.distance : a.game < b.game;
+		};
+		std::vector<std::vector<SimilarGame>> heaps(threads);
+		parallelFor(threads, [&](unsigned t) {
+			auto &heap = heaps[t]; // Max-heap on distance, the worst kept game on top
+			for (size_t g = m_frameScores.size() * t / threads; g < m_frameScores.size() * (t + 1) / threads; g++) {
+				uint32_t distance = metric == Metric::FrameScoreL1
+					? l1(queryScores, m_frameScores[g])
+					: hamming(queryRolls.data(), &m_rolls[g * MAX_ROLLS]);
+				SimilarGame candidate {g, distance};
+				if (heap.size() < k) {
+					heap.push_back(candidate);
+					std::push_heap(heap.begin(), heap.end(), closer);
+				} else if (k > 0 && closer(candidate, heap.front())) {
+					std::pop_heap(heap.begin(), heap.end(), closer);
+					heap.back() = candidate;
+					std::push_heap(heap.begin(), heap.end(), closer);
+				}
+			}
+		});
+
+		std::vector<SimilarGame> best;
+		for (const auto &heap : heaps) {
+			best.insert(best.end(), heap.begin(), heap.end());
+		}
+		std::sort(best.begin(), best.end(), closer);
+		best.resize(std::min(k, best.size()));
+		return best;
+	}
+
+private:
+	using FrameVector = std::array<uint8_t, 16>; // FRAMES scores padded to one SIMD register
+
+	std::vector<uint8_t> m_rolls; // Packed roll rows, MAX_ROLLS per game
+	std::vector<FrameVector> m_frameScores;
+
+	static FrameVector frameScores(const GameBranch &game) {
+		FrameVector scores {};
+		for (uint8_t f = 0; f < FRAMES; f++) {
+			scores[f] = game.state().frameScore(f);
+		}
+		return scores;
+	}
+
+	static uint32_t l1(const FrameVector &a, const FrameVector &b) {
+#ifdef __SSE2__
+		__m128i sad = _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a.data())),
+		                           _mm_loadu_si128(reinterpret_cast<const __m128i *>(b.data())));
+		return _mm_cvtsi128_si32(sad) + _mm_extract_epi16(sad, 4);
+#else
+		uint32_t distance = 0;
+		for (size_t i = 0; i < a.size(); i++) {
+			distance += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+		}
+		return distance;
+#endif
+	}
+
+	static uint32_t hamming(const uint8_t *a, const uint8_t *b) {
+		uint32_t distance = 0;
+		for (size_t i = 0; i < MAX_ROLLS; i++) {
+			distance += a[i] != b[i];
+		}
+		return distance;
+	}
+};
+
+
+/**
+ * @brief Byte-at-a-time table for CRC32C (Castagnoli, reflected polynomial 0x82F63B78)
+ */
+constexpr std::array<uint32_t, 256> buildCrc32cTable() {
+	std::array<uint32_t, 256> table {};
+	for (uint32_t byte = 0; byte < 256; byte++) {
+		uint32_t crc = byte;
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (crc & 1 ? 0x82F63B78u : 0);
+		}
+		table[byte] = crc;
+	}
+	return table;
+}
+
+constexpr std::array<uint32_t, 256> CRC32C_TABLE = buildCrc32cTable();
+
+uint32_t crc32cSoftware(const uint8_t *data, size_t size) {
+	uint32_t crc = ~0u;
+	for (size_t i = 0; i < size; i++) {
+		crc = (crc >> 8) ^ CRC32C_TABLE[(crc ^ data[i]) & 0xff];
+	}
+	return ~crc;
+}
+
+#ifdef CRC32C_HARDWARE
+/**
+ * @brief CRC32C with the SSE4.2 crc32 instruction, 8 bytes per step
+ */
+__attribute__((target("sse4.2"))) uint32_t crc32cHardware(const uint8_t *data, size_t size) {
+	uint64_t crc = ~0u;
+	for (; size >= 8; data += 8, size -= 8) {
+		uint64_t word;
+		std::memcpy(&word, data, sizeof(word));
+		crc = _mm_crc32_u64(crc, word);
+	}
+	uint32_t tail = crc;
+	for (; size > 0; data++, size--) {
+		tail = _mm_crc32_u8(tail, *data);
+	}
+	return ~tail;
+}
+#endif
+
+/**
+ * @brief CRC32C of a buffer, on the SSE4.2 instruction when the CPU has it
+ */
+uint32_t crc32c(const uint8_t *data, size_t size) {
+#ifdef CRC32C_HARDWARE
+	static const bool hardware = __builtin_cpu_supports("sse4.2");
+	if (hardware) {
+		return crc32cHardware(data, size);
+	}
+#endif
+	return crc32cSoftware(data, size);
+}
+
+
+/**
+ * @brief One game in a bowler's history
+ */
+struct GameRecord {
+	uint64_t timestamp;
+	uint16_t total;
+	uint8_t strikes; // Strike balls as marked on the board, 12 in a perfect game
+	uint8_t spares;
+};
+
+/**
+ * @class BowlerHistory
+ * @brief Per-bowler time series of game totals, compressed in blocks of BLOCK_GAMES:
+ *        varint timestamp deltas, 9-bit packed totals, one byte of strikes/spares per game,
+ *        each block sealed with a CRC32C checked on read unless verification is turned off.
+ *        Block time ranges let range scans skip whole blocks; window queries slide
+ *        over the scanned games once instead of rescanning each window.
+ */
+class BowlerHistory {
+public:
+	static constexpr size_t BLOCK_GAMES {128};
+
+	/**
+	 * @brief Appends a completed game
+	 * @return false if the game is not complete or older than the last one
+	 */
+	bool append(uint64_t timestamp, const GameBranch &game) {
+		if (!game.state().complete() || (size() > 0 && timestamp < m_lastTimestamp)) {
+			return false;
+		}
+		GameRecord record {timestamp, static_cast<uint16_t>(game.total()), 0, 0};
+		size_t r = 0;
+		for (uint8_t frame = 0; frame < FRAMES - 1; frame++, r += 2) {
+			if (game.rollAt(r) == PINS) {
+				record.strikes++;
+				r--; // A strike takes one roll
+			} else if (game.rollAt(r) + game.rollAt(r + 1) == BASE_SCORE) {
+				record.spares++;
+			}
+		}
+		// 10th frame: every ball clearing the deck is a mark, and the pins are reset after it.
+		// Clearing a fresh rack is a strike, clearing what the previous ball left a spare (0 then 10 too).
+		bool fresh = true;
+		for (uint8_t standing = PINS; r < game.rollCount(); r++) {
+			if (game.rollAt(r) == standing) {
+				(fresh ? record.strikes : record.spares)++;
+				standing = PINS;
+				fresh = true;
+			} else {
+				standing -= game.rollAt(r);
+				fresh = false;
+			}
+		}
+		m_open.push_back(record);
+		m_lastTimestamp = timestamp;
+		if (m_open.size() == BLOCK_GAMES) {
+			m_blocks.push_back(encode(m_open));
+			m_open.clear();
+		}
+		return true;
+	}
+
+	size_t size() const {
+		return m_blocks.size() * BLOCK_GAMES + m_open.size();
+	}
+
+	/**
+	 * @brief Trusted hot paths can skip checksum verification on read
+	 */
+	void setVerifyChecksums(bool verify) {
+		m_verifyChecksums = verify;
+	}
+
+	/**
+	 * @brief Games with from <= timestamp <= to, oldest first. Blocks failing their
+	 *        checksum are left out and counted in `corruptBlocks` when given.
+	 */
+	std::vector<GameRecord> scan(uint64_t from, uint64_t to, size_t *corruptBlocks = nullptr) const {
+		std::vector<GameRecord> games;
+		for (const auto &block : m_blocks) {
+			if (block.last < from || block.first > to) {
+				continue;
+			}
+			if (m_verifyChecksums && crc32c(block.bytes.data(), block.bytes.size()) != block.checksum) {
+				if (corruptBlocks) {
+					(*corruptBlocks)++;
+				}
+				continue;
+			}
+			for (const auto &record : decode(block)) {
+				if (record.timestamp >= from && record.timestamp <= to) {
+					games.push_back(record);
+				}
+			}
+		}
+		for (const auto &record : m_open) {
+			if (record.timestamp >= from && record.timestamp <= to) {
+				games.push_back(record);
+			}
+		}
+		return games;
+	}
+
+	/**
+	 * @brief Average of the last `window` games at each game in the range (fewer at the start)
+	 * @return nothing if window is 0
+	 */
+	std::vector<double> movingAverage(uint64_t from, uint64_t to, size_t window) const {
+		if (window == 0) {
+			return {};
+		}
+		std::vector<GameRecord> games = scan(from, to);
+		std::vector<double> averages;
+		uint64_t sum = 0;
+		for (size_t g = 0; g < games.size(); g++) {
+			sum += games[g].total;
+			if (g >= window) {
+				sum -= games[g - window].total;
+			}
+			averages.push_back(static_cast<double>(sum) / std::min(g + 1, window));
+		}
+		return averages;
+	}
+
+	/**
+	 * @brief Best 3-game series among the last `window` series, at each series in the range.
+	 *        Series sums slide by one game; the maximum uses a monotonic deque.
+	 * @return nothing if window is 0
+	 */
+	std::vector<uint16_t> rollingBestSeries(uint64_t from, uint64_t to, size_t window) const {
+		if (window == 0) {
+			return {};
+		}
+		std::vector<GameRecord> games = scan(from, to);
+		std::vector<uint16_t> series, best;
+		uint16_t sum = 0;
+		for (size_t g = 0; g < games.size(); g++) {
+			sum += games[g].total;
+			if (g >= SERIES_GAMES) {
+				sum -= games[g - SERIES_GAMES].total;
+			}
+			if (g + 1 >= SERIES_GAMES) {
+				series.push_back(sum);
+			}
+		}
+		std::deque<size_t> candidates; // Indices of decreasing series totals
+		for (size_t s = 0; s < series.size(); s++) {
+			while (!candidates.empty() && series[candidates.back()] <= series[s]) {
+				candidates.pop_back();
+			}
+			candidates.push_back(s);
+			if (candidates.front() + window <= s) {
+				candidates.pop_front();
+			}
+			best.push_back(series[candidates.front()]);
+		}
+		return best;
+	}
+
+private:
+	friend bool checkBowlerHistory(); // Corrupts a sealed block
+
+	struct Block {
+		uint64_t first;
+		uint64_t last;
+		std::vector<uint8_t> bytes;
+		uint32_t checksum; // CRC32C of bytes
+	};
+
+	std::vector<Block> m_blocks; // Sealed, BLOCK_GAMES each
+	std::vector<GameRecord> m_open; // Newest games, sealed into a block when full
+	uint64_t m_lastTimestamp {0};
+	bool m_verifyChecksums {true};
+
+	static Block encode(const std::vector<GameRecord> &games) {
+		Block block {games.front().timestamp, games.back().timestamp, {}, 0};
+		uint64_t previous = block.first;
+		for (const auto &record : games) {
+			for (uint64_t delta = record.timestamp - previous; ; delta >>= 7) {
+				block.bytes.push_back((delta & 0x7f) | (delta >= 0x80 ? 0x80 : 0));
+				if (delta < 0x80) {
+					break;
+				}
+			}
+			previous = record.timestamp;
+		}
+		size_t bitsStart = block.bytes.size();
+		block.bytes.resize(bitsStart + (games.size() * 9 + 7) / 8);
+		for (size_t g = 0; g < games.size(); g++) {
+			for (uint8_t bit = 0; bit < 9; bit++) {
+				size_t at = g * 9 + bit;
+				block.bytes[bitsStart + at / 8] |= (games[g].total >> bit & 1) << (at % 8);
+			}
+		}
+		for (const auto &record : games) {
+			block.bytes.push_back(record.strikes << 4 | record.spares);
+		}
+		block.checksum = crc32c(block.bytes.data(), block.bytes.size());
+		return block;
+	}
+
+	static std::vector<GameRecord> decode(const Block &block) {
+		std::vector<GameRecord> games(BLOCK_GAMES);
+		size_t pos = 0;
+		uint64_t timestamp = block.first;
+		for (auto &record : games) {
+			uint64_t delta = 0;
+			for (uint8_t shift = 0; ; shift += 7) {
+				uint8_t byte = block.bytes[pos++];
+				delta |= static_cast<uint64_t>(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) {
+					break;
+				}
+			}
+			timestamp += delta;
+			record.timestamp = timestamp;
+		}
+		for (size_t g = 0; g < BLOCK_GAMES; g++) {
+			for (uint8_t bit = 0; bit < 9; bit++) {
+				size_t at = g * 9 + bit;
+				games[g].total |= (block.bytes[pos + at / 8] >> (at % 8) & 1) << bit;
+			}
+		}
+		pos += (BLOCK_GAMES * 9 + 7) / 8;
+		for (auto &record : games) {
+			record.strikes = block.bytes[pos] >> 4;
+			record.spares = block.bytes[pos++] & 0xf;
+		}
+		return games;
+	}
+};
+
+
+/**
+ * @class GameDeduplicator
+ * @brief Drops resent or re-imported games at ingest. A game is keyed by (bowler,
+ *        timestamp, rolls packed 4 bits each) and hashed once; the hash picks one of
+ *        SHARDS independently locked shards, so ingestion threads only contend when
+ *        they land on the same shard. Each shard keeps two generations of Bloom filter
+ *        plus exact key set: the Bloom filter answers most new keys without touching
+ *        the set, and when the current generation fills the older one is recycled,
+ *        which bounds memory to about 2 * capacity keys at the cost of forgetting
+ *        games older than that window.
+ */
+class GameDeduplicator {
+public:
+	static constexpr size_t SHARDS {64};
+	static constexpr uint8_t BLOOM_PROBES {4};
+	static constexpr size_t BLOOM_BITS_PER_KEY {10}; // ~1% false positives at 4 probes
+
+	explicit GameDeduplicator(size_t capacity = 1 << 20) :
+			m_shardCapacity(std::max<size_t>(1, capacity / SHARDS)), m_shards(SHARDS) {
+		size_t words = (m_shardCapacity * BLOOM_BITS_PER_KEY + 63) / 64;
+		for (auto &shard : m_shards) {
+			for (auto &generation : shard.generations) {
+				generation.bloom.assign(words, 0);
+				generation.keys.reserve(m_shardCapacity);
+			}
+		}
+	}
+
+	/**
+	 * @brief Safe to call from any number of ingestion threads
+	 * @return true if the game is new and should be ingested, false for a duplicate
+	 */
+	bool admit(uint32_t bowler, uint64_t timestamp, const GameBranch &game) {
+		Key key {timestamp, 0, static_cast<uint32_t>(game.rollCount()) << 20, bowler, 0};
+		for (size_t r = 0; r < game.rollCount(); r++) {
+			if (r < 16) {
+				key.rollsLow |= static_cast<uint64_t>(game.rollAt(r)) << (4 * r);
+			} else {
+				key.rollsHigh |= static_cast<uint32_t>(game.rollAt(r)) << (4 * (r - 16));
+			}
+		}
+		uint64_t hash = mixHash(static_cast<uint64_t>(key.rollsHigh) << 32 | key.bowler);
+		hash = mixHash(hash ^ key.rollsLow);
+		key.hash = hash = mixHash(hash ^ key.timestamp);
+		Shard &shard = m_shards[hash >> 58]; // Top bits pick the shard, low bits feed the Bloom probes
+
+		std::lock_guard<std::mutex> lock(shard.lock);
+		for (const auto &generation : shard.generations) {
+			if (generation.mayContain(hash) && generation.keys.count(key)) {
+				return false;
+			}
+		}
+		if (shard.generations[shard.current].keys.size() >= m_shardCapacity) {
+			shard.current ^= 1;
+			shard.generations[shard.current].clear();
+		}
+		shard.generations[shard.current].insert(key, hash);
+		return true;
+	}
+
+private:
+	struct Key {
+		uint64_t timestamp;
+		uint64_t rollsLow; // Rolls 0-15
+		uint32_t rollsHigh; // Rolls 16-20, roll count in bits 20-24
+		uint32_t bowler;
+		uint64_t hash; // Of the fields above, computed once by admit()
+
+		bool operator==(const Key &other) const {
+			return timestamp == other.timestamp && rollsLow == other.rollsLow
+			       && rollsHigh == other.rollsHigh && bowler == other.bowler;
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key &key) const {
+			return key.hash;
+		}
+	};
+
+	struct Generation {
+		std::vector<uint64_t> bloom;
+		std::unordered_set<Key, KeyHash> keys;
+
+		bool mayContain(uint64_t hash) const {
+			uint64_t bits = bloom.size() * 64, step = hash >> 32 | 1;
+			for (uint8_t p = 0; p < BLOOM_PROBES; p++, hash += step) {
+				uint64_t bit = hash % bits;
+				if (!(bloom[bit / 64] >> (bit % 64) & 1)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void insert(const Key &key, uint64_t hash) {
+			uint64_t bits = bloom.size() * 64, step = hash >> 32 | 1;
+			for (uint8_t p = 0; p < BLOOM_PROBES; p++, hash += step) {
+				uint64_t bit = hash % bits;
+				bloom[bit / 64] |= uint64_t {1} << (bit % 64);
+			}
+			keys.insert(key);
+		}
+
+		void clear() {
+			std::fill(bloom.begin(), bloom.end(), 0);
+			keys.clear();
+		}
+	};
+
+	struct alignas(64) Shard {
+		std::mutex lock;
+		std::array<Generation, 2> generations;
+		uint8_t current {0};
+	};
+
+	size_t m_shardCapacity;
+	std::vector<Shard> m_shards;
+};
+
+
+/**
+ * @class SortedIndex
+ * @brief Secondary index over an archive key column (bowler id, league id, date):
+ *        one sorted run of (key, game) entries plus a sparse fence key per FENCE_STRIDE
+ *        entries. A lookup binary-searches the small fence array, then reads one
+ *        stretch of the run; range scans read the run sequentially.
+ */
+class SortedIndex {
+public:
+	static constexpr size_t FENCE_STRIDE {64};
+
+	/**
+	 * @brief Builds the index: each thread sorts a slice, then slices are merged pairwise
+	 */
+	void build(const std::vector<uint64_t> &keys, unsigned threads) {
+		threads = std::max(1u, threads);
+		m_entries.resize(keys.size());
+		for (size_t g = 0; g < keys.size(); g++) {
+			m_entries[g] = {keys[g], g};
+		}
+
+		std::vector<size_t> bounds;
+		for (unsigned t = 0; t <= threads; t++) {
+			bounds.push_back(keys.size() * t / threads);
+		}
+		parallelFor(threads, [&](unsigned t) {
+			std::sort(m_entries.begin() + bounds[t], m_entries.begin() + bounds[t + 1]);
+		});
+		for (unsigned width = 1; width < threads; width *= 2) {
+			unsigned pairs = (threads - width + 2 * width - 1) / (2 * width);
+			parallelFor(pairs, [&](unsigned pair) {
+				unsigned t = pair * 2 * width;
+				unsigned end = std::min(t + 2 * width, threads);
+				std::inplace_merge(m_entries.begin() + bounds[t], m_entries.begin() + bounds[t + width],
+				                   m_entries.begin() + bounds[end]);
+			});
+		}
+
+		m_fences.clear();
+		for (size_t e = 0; e < m_entries.size(); e += FENCE_STRIDE) {
+			m_fences.push_back(m_entries[e].first);
+		}
+	}
+
+	/**
+	 * @brief Games whose key lies in [from, to], in key order
+	 */
+	std::vector<size_t> range(uint64_t from, uint64_t to) const {
+		std::vector<size_t> games;
+		for (size_t e = firstAtLeast(from); e < m_entries.size() && m_entries[e].first <= to; e++) {
+			games.push_back(m_entries[e].second);
+		}
+		return games;
+	}
+
+	std::vector<size_t> lookup(uint64_t key) const {
+		return range(key, key);
+	}
+
+private:
+	std::vector<std::pair<uint64_t, size_t>> m_entries; // (key, game), sorted
+	std::vector<uint64_t> m_fences; // First key of every FENCE_STRIDE entries
+
+	size_t firstAtLeast(uint64_t key) const {
+		// Last fence below the key starts the only stretch that can hold the first match
+		size_t fence = std::lower_bound(m_fences.begin(), m_fences.end(), key) - m_fences.begin();
+		size_t begin = fence == 0 ? 0 : (fence - 1) * FENCE_STRIDE;
+		size_t end = std::min(m_entries.size(), fence * FENCE_STRIDE + 1);
+		auto first = std::lower_bound(m_entries.begin() + begin, m_entries.begin() + end, key,
+			[](const std::pair<uint64_t, size_t> &entry, uint64_t k) { return entry.first < k; });
+		return first - m_entries.begin();
+	}
+};
+
+
+/**
+ * @brief Position where a frame pattern matched: the game's index in the archive and
+ *        the frame (0-based) on which the match ends
+ */
+struct FrameMatch {
+	size_t game;
+	uint8_t endFrame;
+};
+
+/**
+ * @class FramePattern
+ * @brief Regular expressions over the frames of a game, compiled to a DFA
+ *        X        strike
+ *        /        spare
+ *        O        open frame
+ *        0-9      non-strike frame whose first ball knocked down that many pins
+ *        .        any frame
+ *        [X/]     any of the listed classes
+ *        ( ) |    grouping and alternation
+ *        * + ?    repetition
+ *        ^ $      start of game / after the 10th frame, only at the ends of the pattern
+ *        e.g. "XXO" a double followed by an open, "^...(/X)+" spare-strike alternation from frame 4
+ *        Patterns that match zero frames ("", "X*") are rejected. The DFA is only built as deep
+ *        as a game is long, FRAMES frames plus the end, and may have at most MAX_STATES states.
+ */
+class FramePattern {
+public:
+	static constexpr size_t MAX_STATES {std::numeric_limits<uint16_t>::max()};
+
+	/**
+	 * @return false if the pattern has a syntax error, matches zero frames or needs more
+	 *         than MAX_STATES DFA states, leaving the previous pattern in place
+	 */
+	bool compile(const std::string &pattern) {
+		std::vector<NfaState> nfa;
+		size_t pos = 0;
+		bool anchored = !pattern.empty() && pattern[0] == '^';
+		pos += anchored;
+		bool atEnd = pattern.size() > pos && pattern.back() == '$';
+		std::string body = pattern.substr(pos, pattern.size() - pos - atEnd);
+
+		pos = 0;
+		Fragment fragment;
+		if (!parseAlternation(body, pos, nfa, fragment) || pos != body.size()) {
+			return false;
+		}
+		if (atEnd) {
+			fragment = concat(nfa, fragment, symbolFragment(nfa, 1u << END));
+		}
+		return buildDfa(nfa, fragment, anchored);
+	}
+
+	/**
+	 * @brief Scans an archive on `threads` cores, returning every match in game order
+	 */
+	std::vector<FrameMatch> scan(const GameColumns &games, unsigned threads) const {
+		threads = std::max(1u, threads);
+		std::vector<std::vector<FrameMatch>> found(threads);
+		parallelFor(threads, [&](unsigned t) {
+			for (size_t g = games.size() * t / threads; g < games.size() * (t + 1) / threads; g++) {
+				scanGame(games, g, found[t]);
+			}
+		});
+
+		std::vector<FrameMatch> matches;
+		for (const auto &part : found) {
+			matches.insert(matches.end(), part.begin(), part.end());
+		}
+		return matches;
+	}
+
+	bool compiled() const {
+		return !m_transitions.empty();
+	}
+
+	/**
+	 * @brief DFA walk for callers that generate frames instead of scanning stored games:
+	 *        start from state 0, step once per frame with its first two balls, then finish()
+	 *        after the 10th. A game matches if any state on the way is accepting.
+	 */
+	uint16_t step(uint16_t state, uint8_t r1, uint8_t r2) const {
+		return m_transitions[state][r1 == PINS ? STRIKE : (r1 + r2 == BASE_SCORE ? SPARE + r1 : r1)];
+	}
+
+	uint16_t finish(uint16_t state) const {
+		return m_transitions[state][END];
+	}
+
+	bool accepting(uint16_t state) const {
+		return m_accepting[state];
+	}
+
+private:
+	// Frame symbols: open frames 0-9 and spares 10-19 by first ball, then strike and end of game
+	static constexpr uint8_t SPARE {10};
+	static constexpr uint8_t STRIKE {20};
+	static constexpr uint8_t END {21};
+	static constexpr uint8_t SYMBOLS {22};
+	static constexpr uint32_t OPEN_MASK {(1u << SPARE) - 1};
+	static constexpr uint32_t SPARE_MASK {OPEN_MASK << SPARE};
+	static constexpr uint32_t STRIKE_MASK {1u << STRIKE};
+
+	struct NfaState {
+		uint32_t mask {0}; // Symbols leading to `next`
+		int next {-1};
+		int epsilon[2] {-1, -1};
+	};
+
+	struct Fragment {
+		int start;
+		int end;
+	};
+
+	std::vector<std::array<uint16_t, SYMBOLS>> m_transitions; // DFA, state 0 is the start
+	std::vector<uint8_t> m_accepting;
+
+	static int addState(std::vector<NfaState> &nfa) {
+		nfa.emplace_back();
+		return nfa.size() - 1;
+	}
+
+	static Fragment symbolFragment(std::vector<NfaState> &nfa, uint32_t mask) {
+		int start = addState(nfa), end = addState(nfa);
+		nfa[start].mask = mask;
+		nfa[start].next = end;
+		return {start, end};
+	}
+
+	static Fragment concat(std::vector<NfaState> &nfa, Fragment first, Fragment second) {
+		nfa[first.end].epsilon[0] = second.start;
+		return {first.start, second.end};
+	}
+
+	static bool parseAlternation(const std::string &text, size_t &pos, std::vector<NfaState> &nfa, Fragment &out) {
+		if (!parseSequence(text, pos, nfa, out)) {
+			return false;
+		}
+		while (pos < text.size() && text[pos] == '|') {
+			Fragment other;
+			if (!parseSequence(text, ++pos, nfa, other)) {
+				return false;
+			}
+			int start = addState(nfa), end = addState(nfa);
+			nfa[start].epsilon[0] = out.start;
+			nfa[start].epsilon[1] = other.start;
+			nfa[out.end].epsilon[0] = end;
+			nfa[other.end].epsilon[0] = end;
+			out = {start, end};
+		}
+		return true;
+	}
+
+	static bool parseSequence(const std::string &text, size_t &pos, std::vector<NfaState> &nfa, Fragment &out) {
+		int empty = addState(nfa);
+		out = {empty, empty};
+		while (pos < text.size() && text[pos] != '|' && text[pos] != ')') {
+			Fragment item;
+			if (!parseRepeat(text, pos, nfa, item)) {
+				return false;
+			}
+			out = concat(nfa, out, item);
+		}
+		return true;
+	}
+
+	static bool parseRepeat(const std::string &text, size_t &pos, std::vector<NfaState> &nfa, Fragment &out) {
+		if (!parseAtom(text, pos, nfa, out)) {
+			return false;
+		}
+		while (pos < text.size() && (text[pos] == '*' || text[pos] == '+' || text[pos] == '?')) {
+			char op = text[pos++];
+			int start = addState(nfa), end = addState(nfa);
+			nfa[start].epsilon[0] = out.start;
+			nfa[start].epsilon[1] = op == '+' ? -1 : end;
+			nfa[out.end].epsilon[0] = op == '?' ? end : out.start;
+			nfa[out.end].epsilon[1] = op == '?' ? -1 : end;
+			out = {start, end};
+		}
+		return true;
+	}
+
+	static bool parseAtom(const std::string &text, size_t &pos, std::vector<NfaState> &nfa, Fragment &out) {
+		if (pos == text.size()) {
+			return false;
+		}
+		char c = text[pos++];
+		if (c == '(') {
+			if (!parseAlternation(text, pos, nfa, out) || pos == text.size() || text[pos] != ')') {
+				return false;
+			}
+			pos++;
+			return true;
+		}
+		uint32_t mask = 0;
+		if (c == '[') {
+			while (pos < text.size() && text[pos] != ']') {
+				uint32_t classMask = classOf(text[pos++]);
+				if (classMask == 0) {
+					return false;
+				}
+				mask |= classMask;
+			}
+			if (pos++ == text.size()) {
+				return false;
+			}
+		} else {
+			mask = classOf(c);
+		}
+		if (mask == 0) {
+			return false;
+		}
+		out = symbolFragment(nfa, mask);
+		return true;
+	}
+
+	static uint32_t classOf(char c) {
+		if (c >= '0' && c <= '9') {
+			return (1u << (c - '0')) | (1u << (SPARE + c - '0'));
+		}
+		switch (c) {
+		case 'X': return STRIKE_MASK;
+		case '/': return SPARE_MASK;
+		case 'O': return OPEN_MASK;
+		case '.': return OPEN_MASK | SPARE_MASK | STRIKE_MASK;
+		default: return 0;
+		}
+	}
+
+	using StateSet = std::vector<bool>;
+
+	static void closure(const std::vector<NfaState> &nfa, int state, StateSet &set) {
+		if (state < 0 || set[state]) {
+			return;
+		}
+		set[state] = true;
+		closure(nfa, nfa[state].epsilon[0], set);
+		closure(nfa, nfa[state].epsilon[1], set);
+	}
+
+	/**
+	 * @brief Subset construction, breadth first. Unanchored patterns re-add the start
+	 *        closure after every frame, so a match may begin anywhere. States first reached
+	 *        after FRAMES + 1 symbols are never stepped from and loop on themselves.
+	 * @return false, leaving the DFA untouched, for a pattern matching zero frames or one
+	 *         needing more than MAX_STATES states
+	 */
+	bool buildDfa(const std::vector<NfaState> &nfa, Fragment fragment, bool anchored) {
+		StateSet startSet(nfa.size());
+		closure(nfa, fragment.start, startSet);
+		if (startSet[fragment.end]) {
+			return false;
+		}
+
+		std::map<StateSet, uint16_t> ids {{startSet, 0}};
+		std::vector<StateSet> sets {startSet};
+		std::vector<uint8_t> depths {0}; // Symbols needed to first reach each state
+		std::vector<std::array<uint16_t, SYMBOLS>> transitions;
+		std::vector<uint8_t> accepting;
+		for (size_t d = 0; d < sets.size(); d++) {
+			std::array<uint16_t, SYMBOLS> row;
+			row.fill(d);
+			for (uint8_t symbol = 0; symbol < SYMBOLS && depths[d] <= FRAMES; symbol++) {
+				StateSet next(nfa.size());
+				if (!anchored && symbol != END) {
+					next = startSet;
+				}
+				for (size_t s = 0; s < nfa.size(); s++) {
+					if (sets[d][s] && (nfa[s].mask >> symbol & 1)) {
+						closure(nfa, nfa[s].next, next);
+					}
+				}
+				auto found = ids.find(next);
+				if (found == ids.end()) {
+					if (sets.size() == MAX_STATES) {
+						return false;
+					}
+					found = ids.emplace(next, sets.size()).first;
+					sets.push_back(next);
+					depths.push_back(depths[d] + 1);
+				}
+				row[symbol] = found->second;
+			}
+			transitions.push_back(row);
+			accepting.push_back(sets[d][fragment.end]);
+		}
+		m_transitions = std::move(transitions);
+		m_accepting = std::move(accepting);
+		return true;
+	}
+
+	void scanGame(const GameColumns &games, size_t game, std::vector<FrameMatch> &matches) const {
+		const uint8_t *rolls = &games.rolls[game * MAX_ROLLS];
+		size_t count = games.rollCounts[game];
+		uint16_t state = 0;
+		size_t i = 0;
+		for (uint8_t frame = 0; frame < FRAMES; frame++) {
+			if (i == count || (rolls[i] != PINS && i + 1 == count)) {
+				return; // Unfinished frame
+			}
+			uint8_t r1 = rolls[i];
+			uint8_t symbol = r1 == PINS ? STRIKE : (r1 + rolls[i + 1] == BASE_SCORE ? SPARE + r1 : r1);
+			state = m_transitions[state][symbol];
+			if (m_accepting[state]) {
+				matches.push_back({game, frame});
+			}
+			if (frame == FRAMES - 1) {
+				i += symbol >= SPARE ? 3 : 2; // Strike or spare earns the third ball
+			} else {
+				i += r1 == PINS ? 1 : 2;
+			}
+		}
+		if (i != count) {
+			return; // 10th frame still waiting for its third ball
+		}
+		state = m_transitions[state][END];
+		if (m_accepting[state] && (matches.empty() || matches.back().game != game || matches.back().endFrame != FRAMES - 1)) {
+			matches.push_back({game, FRAMES - 1});
+		}
+	}
+};
+
+
+/**
+ * @class ScoreSpace
+ * @brief DP tables over the scoring state space: which extra points are still reachable
+ *        from each state, and by how many distinct roll sequences. Lets searches skip
+ *        every branch that cannot end on the score they look for, and samplers draw
+ *        legal games exactly uniformly.
+ */
+class ScoreSpace {
+public:
+	using ScoreSet = std::bitset<MAX_SCORE + 1>;
+	using ScoreCounts = std::array<uint64_t, MAX_SCORE + 1>; // All ~5.7e18 games fit in 64 bits
+
+	ScoreSpace() {
+		build(ScoreState());
+	}
+
+	/**
+	 * @brief Whether a game in this state can still finish with exactly `target`
+	 */
+	bool canReach(const ScoreState &state, uint16_t target) const {
+		return target >= state.total() && target <= MAX_SCORE
+			&& m_reachable[slot(state)][target - state.total()];
+	}
+
+	/**
+	 * @brief Number of ways to finish a game from this state, in total or with exactly `target`
+	 */
+	uint64_t countGames(const ScoreState &state) const {
+		return m_gameCounts[slot(state)];
+	}
+
+	uint64_t countGames(const ScoreState &state, uint16_t target) const {
+		if (target < state.total() || target > MAX_SCORE) {
+			return 0;
+		}
+		return m_scoreCounts[slot(state)][target - state.total()];
+	}
+
+	/**
+	 * @brief Draws a game uniformly from all legal games, O(rolls) table lookups
+	 */
+	GameBranch sample(std::mt19937_64 &rng) const {
+		return draw(rng, [&](uint16_t slot, uint16_t) { return m_gameCounts[slot]; });
+	}
+
+	/**
+	 * @brief Draws a game uniformly from the games scoring `target`,
+	 *        or returns an empty game if no game scores `target`
+	 */
+	GameBranch sample(std::mt19937_64 &rng, uint16_t target) const {
+		if (countGames(ScoreState(), target) == 0) {
+			return GameBranch();
+		}
+		return draw(rng, [&](uint16_t slot, uint16_t total) {
+			return total <= target ? m_scoreCounts[slot][target - total] : 0;
+		});
+	}
+
+	/**
+	 * @brief Fills `games` with `count` uniform samples (all games when `target` < 0),
+	 *        each thread drawing a contiguous slice from its own seeded generator
+	 */
+	void sampleBatch(GameColumns &games, size_t count, int target, uint64_t seed, unsigned threads) const {
+		games.resize(count);
+		threads = std::max(1u, threads);
+		parallelFor(threads, [&](unsigned t) {
+			std::mt19937_64 rng(seed + t);
+			for (size_t g = count * t / threads; g < count * (t + 1) / threads; g++) {
+				games.store(g, target < 0 ? sample(rng) : sample(rng, target));
+			}
+		});
+	}
+
+	/**
+	 * @brief Calls `visit` with every complete game scoring `target`, in roll order
+	 */
+	template <typename Visitor>
+	void enumerate(uint16_t target, Visitor &&visit) const {
+		search(GameBranch(), target, visit);
+	}
+
+	/**
+	 * @brief Number of complete games scoring `target` that `pattern` matches, i.e. for
+	 *        which FramePattern::scan would report at least one match. A DP over (game
+	 *        state, total, DFA state) at frame boundaries; once the DFA accepts, the rest
+	 *        of the game comes straight from the score counts, so no game is enumerated.
+	 */
+	uint64_t countGames(uint16_t target, const FramePattern &pattern) const {
+		if (!pattern.compiled() || target > MAX_SCORE) {
+			return 0;
+		}
+		std::unordered_map<uint64_t, uint64_t> memo;
+		return countMatching(ScoreState(), target, 0, pattern, memo);
+	}
+
+	/**
+	 * @brief Streams the games of enumerate() from `threads` workers, the search tree split
+	 *        by the outcome of the first frame. `visit` is called concurrently, in no
+	 *        particular order, and must be thread-safe; nothing is buffered here.
+	 */
+	template <typename Visitor>
+	void enumerateParallel(uint16_t target, unsigned threads, Visitor &&visit) const {
+		std::vector<GameBranch> roots;
+		for (uint8_t r1 = 0; r1 <= PINS; r1++) {
+			GameBranch first;
+			first.roll(r1);
+			for (uint8_t r2 = 0; r1 != PINS && r2 <= PINS - r1; r2++) {
+				GameBranch open = first.fork();
+				open.roll(r2);
+				roots.push_back(open);
+			}
+			if (r1 == PINS) {
+				roots.push_back(first);
+			}
+		}
+
+		std::atomic<size_t> nextRoot {0};
+		parallelFor(std::max(1u, threads), [&](unsigned) {
+			for (size_t i = nextRoot++; i < roots.size(); i = nextRoot++) {
+				search(roots[i], target, visit);
+			}
+		});
+	}
+
+private:
+	static constexpr uint16_t NO_SLOT {std::numeric_limits<uint16_t>::max()};
+
+	/**
+	 * @brief Where a roll of a given pin count leads from a slot
+	 */
+	struct Transition {
+		uint16_t slot;
+		uint8_t gained; // Points the roll adds to the total, bonuses included
+	};
+
+	std::vector<uint16_t> m_slots = std::vector<uint16_t>(1 << 16, NO_SLOT); // futureKey() -> table slot
+	// Indexed by slot, one per distinct future
+	std::vector<ScoreSet> m_reachable; // Extra points still reachable
+	std::vector<ScoreCounts> m_scoreCounts; // Ways to finish, by extra points
+	std::vector<uint64_t> m_gameCounts; // Ways to finish
+	std::vector<std::array<Transition, PINS + 1>> m_transitions; // Successor per pin count
+
+	uint16_t slot(const ScoreState &state) const {
+		return m_slots[state.futureKey()];
+	}
+
+	void build(const ScoreState &state) {
+		if (slot(state) != NO_SLOT) {
+			return;
+		}
+		ScoreSet extra;
+		ScoreCounts counts {};
+		std::array<Transition, PINS + 1> transitions {};
+		uint64_t games = 0;
+		if (state.complete()) {
+			extra.set(0);
+			counts[0] = 1;
+			games = 1;
+		}
+		for (int pins = 0; pins <= state.pinsStanding(); pins++) {
+			ScoreState next = state;
+			next.apply(pins);
+			build(next);
+			uint16_t gained = next.total() - state.total();
+			uint16_t nextSlot = slot(next);
+			extra |= m_reachable[nextSlot] << gained;
+			for (uint16_t e = 0; e + gained <= MAX_SCORE; e++) {
+				counts[e + gained] += m_scoreCounts[nextSlot][e];
+			}
+			games += m_gameCounts[nextSlot];
+			transitions[pins] = {nextSlot, static_cast<uint8_t>(gained)};
+		}
+		m_slots[state.futureKey()] = m_reachable.size();
+		m_reachable.push_back(extra);
+		m_scoreCounts.push_back(counts);
+		m_gameCounts.push_back(games);
+		m_transitions.push_back(transitions);
+	}
+
+	/**
+	 * @brief Walks from the empty game, picking each roll with probability proportional
+	 *        to the number of games it leads to
+	 */
+	template <typename Weight>
+	GameBranch draw(std::mt19937_64 &rng, Weight weight) const {
+		GameBranch game;
+		uint16_t at = slot(game.state());
+		while (!game.state().complete()) {
+			uint64_t pick = std::uniform_int_distribution<uint64_t>(0, weight(at, game.total()) - 1)(rng);
+			for (int pins = 0; pins <= game.state().pinsStanding(); pins++) {
+				const Transition &next = m_transitions[at][pins];
+				uint64_t ways = weight(next.slot, game.total() + next.gained);
+				if (pick < ways) {
+					game.roll(pins);
+					at = next.slot;
+					break;
+				}
+				pick -= ways;
+			}
+		}
+		return game;
+	}
+
+	/**
+	 * @brief Games from `state`, at the start of a frame, that score `target` and match
+	 *        from DFA state `dfa`. Memoized on the frame boundary.
+	 */
+	uint64_t countMatching(const ScoreState &state, uint16_t target, uint16_t dfa, const FramePattern &pattern,
+	                       std::unordered_map<uint64_t, uint64_t> &memo) const {
+		uint64_t key = static_cast<uint64_t>(dfa) << 32 | static_cast<uint64_t>(state.total()) << 16 | state.futureKey();
+		auto found = memo.find(key);
+		if (found != memo.end()) {
+			return found->second;
+		}
+		uint64_t games = 0;
+		auto frameDone = [&](const ScoreState &next, uint8_t r1, uint8_t r2) {
+			if (!canReach(next, target)) {
+				return;
+			}
+			uint16_t after = pattern.step(dfa, r1, r2);
+			if (pattern.accepting(after)) {
+				games += countGames(next, target);
+			} else if (next.complete()) {
+				games += pattern.accepting(pattern.finish(after));
+			} else {
+				games += countMatching(next, target, after, pattern, memo);
+			}
+		};
+		// Every way to roll this frame: one ball for a strike before the 10th, up to three in it
+		for (uint8_t r1 = 0; r1 <= state.pinsStanding(); r1++) {
+			ScoreState first = state;
+			first.apply(r1);
+			if (first.frame() != state.frame()) {
+				frameDone(first, r1, 0);
+				continue;
+			}
+			for (uint8_t r2 = 0; r2 <= first.pinsStanding(); r2++) {
+				ScoreState second = first;
+				second.apply(r2);
+				if (second.frame() != state.frame()) {
+					frameDone(second, r1, r2);
+					continue;
+				}
+				for (uint8_t r3 = 0; r3 <= second.pinsStanding(); r3++) {
+					ScoreState third = second;
+					third.apply(r3);
+					frameDone(third, r1, r2);
+				}
+			}
+		}
+		memo.emplace(key, games);
+		return games;
+	}
+
+	template <typename Visitor>
+	void search(const GameBranch &game, uint16_t target, Visitor &visit) const {
+		if (!canReach(game.state(), target)) {
+			return;
+		}
+		if (game.state().complete()) {
+			visit(game);
+			return;
+		}
+		for (int pins = 0; pins <= game.state().pinsStanding(); pins++) {
+			GameBranch next = game.fork();
+			next.roll(pins);
+			search(next, target, visit);
+		}
+	}
+};
+
+
+/**
+ * @class BowlingGame
+ * @brief Simulates the bowling game and calculates scores
+ */
+class BowlingGame {
+public:
+	BowlingGame() = default;
+
+	/**
+	 * @brief Materializes a branch, e.g. to display its board
+	 */
+	explicit BowlingGame(const GameBranch &branch) {
+		for (size_t i = 0; i < branch.rollCount(); i++) {
+			roll(branch.rollAt(i));
+		}
+	}
+
+	/**
+	 * @brief Records a roll
+	 * @return false, recording nothing, if more pins than are standing are knocked down
+	 *         or the game is already complete
+	 */
+	bool roll(uint8_t pins) {
+		if (pins > liveState().pinsStanding()) {
+			return false;
+		}
+		m_rolls.push_back(pins);
+		m_state.apply(pins);
+		m_boards.push_back(m_state.checkpoint());
+		m_frameTypes.clear();
+		m_framesValid = m_scoresValid = false;
+		return true;
+	}
+
+	/**
+	 * @brief Total score so far, straight from the incremental state without building frames
+	 */
+	int total() const {
+		return liveState().total();
+	}
+
+	/**
+	 * @brief Whether a frame's score is settled, pending bonus balls, or not started
+	 */
+	FrameStatus frameStatus(uint8_t frame) const {
+		return liveState().status(frame);
+	}
+
+	/**
+	 * @brief Scoring state kept up to date by every roll
+	 */
+	const ScoreState &liveState() const {
+		return m_state;
+	}
+
+	/**
+	 * @brief Running and best reachable score for every possible next ball
+	 */
+	NextBallOutcomes nextBallOutcomes() const {
+		return liveState().nextBallOutcomes();
+	}
+
+	/**
+	 * @brief Board as of a roll, without replaying the game: running total, current frame
+	 *        and pending bonuses after the first `rollIndex` rolls (0 = empty board)
+	 * @return false, leaving `board` untouched, if rollIndex > rollCount()
+	 */
+	bool boardAt(size_t rollIndex, BoardCheckpoint &board) const {
+		if (rollIndex >= m_boards.size()) {
+			return false;
+		}
+		board = m_boards[rollIndex];
+		return true;
+	}
+
+	/**
+	 * @brief Running score the board showed for a frame after the first `rollIndex` rolls.
+	 *        Only settled frames show a score, and those match the live frame scores.
+	 * @return false, leaving `score` untouched, if rollIndex > rollCount() or the frame
+	 *         was not settled yet (blank on the board)
+	 */
+	bool scoreAt(size_t rollIndex, uint8_t frame, uint16_t &score) const {
+		BoardCheckpoint board;
+		if (frame >= FRAMES || !boardAt(rollIndex, board) || board.status(frame) != FrameStatus::Final) {
+			return false;
+		}
+		score = liveState().runningScore(frame);
+		return true;
+	}
+
+	size_t rollCount() const {
+		return m_rolls.size();
+	}
+
+	/**
+	 * @brief Starts over with an empty game, keeping allocated storage for reuse
+	 */
+	void clear() {
+		m_rolls.clear();
+		m_scores.clear();
+		m_frames.clear();
+		m_frameTypes.clear();
+		m_state = ScoreState();
+		m_boards.resize(1);
+		m_framesValid = m_scoresValid = true;
+	}
+
+	/**
+	 * @brief Branches the live game for what-if scoring without touching this game
+	 */
+	GameBranch fork() const {
+		return GameBranch(m_rolls, liveState());
+	}
+
+	/**
+	 * @brief Frame objects, built by processFrames() on first use after a roll
+	 */
+	const std::vector<std::unique_ptr<Frame>> &frames() {
+		if (!m_framesValid) {
+			processFrames();
+		}
+		return m_frames;
+	}
+
+	/**
+	 * @brief Cumulative score per frame, computed by calculateScore() on first use after a roll
+	 */
+	const std::vector<uint16_t> &scores() {
+		if (!m_scoresValid) {
+			calculateScore();
+		}
+		return m_scores;
+	}
+
+	/**
+	 * @brief Formatted representation of a frame, cached until the next roll
+	 */
+	const std::string &frameType(size_t frame) {
+		if (m_frameTypes.empty()) {
+			for (const auto &f : frames()) {
+				m_frameTypes.push_back(f->frameType());
+			}
+		}
+		return m_frameTypes[frame];
+	}
+
+	void processFrames() {
+		m_frames.clear();
+		m_frameTypes.clear();
+		size_t i = 0;
+
+		while (m_frames.size() < FRAMES - 1 && i < m_rolls.size()) {
+			m_frameStarts[m_frames.size()] = i;
+			uint8_t r1 = m_rolls[i++];
+			uint8_t r2 = (r1 != PINS && i < m_rolls.size()) ? m_rolls[i++] : 0;
+			m_frames.push_back(FrameFactory::createFrame(m_frames.size(), r1, r2));
+		}
+
+		// 10th frame
+		if (i < m_rolls.size()) {
+			uint8_t r1 = m_rolls[i++];
+			uint8_t r2 = (i < m_rolls.size()) ? m_rolls[i++] : 0;
+			uint8_t r3 = (i < m_rolls.size() && (r1 == PINS || r1 + r2 == PINS)) ? m_rolls[i++] : 0;
+			m_frames.push_back(FrameFactory::createFrame(FRAMES - 1, r1, r2, r3));
+		}
+		m_framesValid = true;
+		m_scoresValid = false;
+	}
+
+
+	void displayBoard() {
+		std::cout << "\nFrame |";
+		for (size_t i = 1; i <= FRAMES; i++) {
+			std::cout << " " << std::setw(4) << i << " |";
+		}
+		std::cout << "\n-----------------------------------------------------------------------------\n";
+
+		std::cout << "Rolls |";
+		for (size_t i = 0; i < frames().size(); i++) {
+			std::cout << " " << std::setw(4) << frameType(i) << " |";
+		}
+		std::cout << "\n-----------------------------------------------------------------------------\n";
+
+		std::cout << "Score |";
+		uint16_t runningScore = 0;
+		for (size_t i = 0; i < scores().size(); i++) {
+			runningScore = m_scores[i];
+			if (frameStatus(i) == FrameStatus::Final) {
+				std::cout << " " << std::setw(4) << runningScore << " |";
+			} else { // Blank until the bonus balls are in, like a real scoreboard
+				std::cout << " " << std::setw(4) << "" << " |";
+			}
+		}
+		std::cout << "\n";
+	}
+
+	int calculateScore() {
+		std::array<uint16_t, FRAMES> frameScores {};
+		size_t frameCount = frames().size();
+		m_scores.clear();
+
+		// First 9 frames: one table gather each, bonus included
+		for (size_t i = 0; i < frameCount && i < FRAMES - 1; i++) {
+			size_t start = m_frameStarts[i];
+			frameScores[i] = FRAME_SCORE_TABLE[frameCode(rollAt(start), rollAt(start + 1), rollAt(start + 2))];
+		}
+		if (frameCount == FRAMES) { // 10th frame has no bonus
+			frameScores[FRAMES - 1] = m_frames[FRAMES - 1]->score();
+		}
+
+		int totalScore = 0;
+		for (size_t i = 0; i < frameCount; i++) {
+			totalScore += frameScores[i];
+			m_scores.push_back(totalScore);
+		}
+		m_scoresValid = true;
+
+		return totalScore;
+	}
+
+
+private:
+	std::vector<uint8_t> m_rolls;
+	std::vector<uint16_t> m_scores;
+	std::vector<std::unique_ptr<Frame>> m_frames;
+	std::array<size_t, FRAMES - 1> m_frameStarts {}; // Roll index of the first roll of frames 1-9
+	ScoreState m_state;
+	std::vector<BoardCheckpoint> m_boards {BoardCheckpoint()}; // Board before the first roll and after every roll
+	std::vector<std::string> m_frameTypes; // Filled by frameType() on demand
+	bool m_framesValid {true}; // m_frames matches m_rolls
+	bool m_scoresValid {true}; // m_scores matches m_rolls
+
+	uint8_t rollAt(size_t index) const {
+		return index < m_rolls.size() ? m_rolls[index] : 0; // Missing bonus rolls count as 0
+	}
+};
+
+/**
+ * @brief Live game values a standing query can test
+ */
+enum class GameField : uint8_t {
+	Total, // Running total of the current game
+	MaxPossible, // Best total the current game can still reach
+	Frame, // Frames completed in the current game
+	StrikeStreak, // Consecutive strikes, across games on the lane
+	SeriesTotal, // Series so far, current game's running total included
+	SeriesMaxPossible, // Best series still reachable, the current game at its max possible
+	Count
+};
+
+enum class Compare : uint8_t {
+	AtLeast,
+	AtMost,
+	Equal
+};
+
+/**
+ * @brief One clause of a standing query, e.g. {MaxPossible, Equal, 300}
+ */
+struct Condition {
+	GameField field;
+	Compare op;
+	uint16_t value;
+};
+
+/**
+ * @brief A standing query that became true on a lane
+ */
+struct Alert {
+	size_t lane;
+	size_t query;
+};
+
+/**
+ * @class StandingQueries
+ * @brief Continuous queries over all live lanes, e.g.
+ *        working on a 300:  {MaxPossible, Equal, 300}, {Frame, AtLeast, 6}
+ *        11 in a row:       {StrikeStreak, AtLeast, 11}
+ *        800 series watch:  {SeriesMaxPossible, AtLeast, 800}, {Frame, AtLeast, 1}
+ *        Clauses are compiled to range checks (field - low <= span) kept in flat arrays.
+ *        Each roll updates the lane's incremental state, computes the fields once and runs
+ *        every clause branch-free. A query alerts when it turns true.
+ */
+class StandingQueries {
+public:
+	/**
+	 * @brief Registers a conjunction of conditions
+	 * @return query id reported in alerts
+	 */
+	size_t add(const std::vector<Condition> &conditions) {
+		for (const auto &condition : conditions) {
+			uint16_t low = condition.op == Compare::AtMost ? 0 : condition.value;
+			uint16_t high = condition.op == Compare::AtLeast ? std::numeric_limits<uint16_t>::max() : condition.value;
+			m_fields.push_back(static_cast<uint8_t>(condition.field));
+			m_lows.push_back(low);
+			m_spans.push_back(high - low);
+		}
+		m_queryEnds.push_back(m_fields.size());
+		m_clauseMatches.resize(m_fields.size());
+		for (auto &lane : m_lanes) {
+			lane.active.push_back(0);
+		}
+		return m_queryEnds.size() - 1;
+	}
+
+	/**
+	 * @brief Feeds one roll of a lane and appends the queries that just became true
+	 * @return false, changing nothing, if the roll is not valid on that lane
+	 */
+	bool roll(size_t lane, uint8_t pins, std::vector<Alert> &alerts) {
+		if (lane >= m_lanes.size()) {
+			m_lanes.resize(lane + 1, LaneState {GameBranch(), 0, 0, 0, true, std::vector<uint8_t>(m_queryEnds.size())});
+		}
+		LaneState &state = m_lanes[lane];
+		bool cleared = pins == state.game.state().pinsStanding();
+		if (!state.game.roll(pins)) {
+			return false;
+		}
+		state.streak = cleared && state.freshRack ? state.streak + 1 : 0;
+		state.freshRack = cleared || !state.freshRack;
+
+		const ScoreState &score = state.game.state();
+		uint16_t maxPossible = score.maxPossible();
+		std::array<uint16_t, static_cast<size_t>(GameField::Count)> fields {
+			score.total(),
+			maxPossible,
+			score.frame(),
+			state.streak,
+			static_cast<uint16_t>(state.seriesTotal + score.total()),
+			static_cast<uint16_t>(state.seriesTotal + maxPossible + (SERIES_GAMES - 1 - state.seriesGames) * MAX_SCORE),
+		};
+
+		for (size_t c = 0; c < m_fields.size(); c++) {
+			m_clauseMatches[c] = static_cast<uint16_t>(fields[m_fields[c]] - m_lows[c]) <= m_spans[c];
+		}
+		size_t begin = 0;
+		for (size_t query = 0; query < m_queryEnds.size(); query++) {
+			uint8_t match = 1;
+			for (size_t c = begin; c < m_queryEnds[query]; c++) {
+				match &= m_clauseMatches[c];
+			}
+			if (match > state.active[query]) {
+				alerts.push_back({lane, query});
+			}
+			state.active[query] = match;
+			begin = m_queryEnds[query];
+		}
+
+		if (score.complete()) { // Next roll starts a new game, or a new series after three
+			state.seriesTotal += score.total();
+			state.seriesGames++;
+			state.game = GameBranch();
+			state.freshRack = true;
+			if (state.seriesGames == SERIES_GAMES) {
+				state.seriesTotal = 0;
+				state.seriesGames = 0;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Ends a lane's session: an unfinished game is finalized with calculateScore
+	 *        semantics (missing bonus rolls count as 0) and the series starts over
+	 * @return the finalized game's score, or -1 if no game was in progress
+	 */
+	int abandon(size_t lane) {
+		if (lane >= m_lanes.size()) {
+			return -1;
+		}
+		LaneState &state = m_lanes[lane];
+		int score = state.game.rollCount() > 0 ? BowlingGame(state.game).calculateScore() : -1;
+		state.game = GameBranch();
+		state.seriesTotal = 0;
+		state.seriesGames = 0;
+		state.streak = 0;
+		state.freshRack = true;
+		std::fill(state.active.begin(), state.active.end(), 0);
+		return score;
+	}
+
+private:
+	struct LaneState {
+		GameBranch game;
+		uint16_t seriesTotal; // Completed games of the current series
+		uint8_t seriesGames;
+		uint8_t streak;
+		bool freshRack; // Next ball is the first at a newly set rack (0 then 10 is a spare)
+		std::vector<uint8_t> active; // Per query, 1 if it matched at the previous roll
+	};
+
+	// All queries' clauses back to back, as field - low <= span
+	std::vector<uint8_t> m_fields;
+	std::vector<uint16_t> m_lows;
+	std::vector<uint16_t> m_spans;
+	std::vector<uint8_t> m_clauseMatches; // Scratch, per clause
+	std::vector<size_t> m_queryEnds; // End of each query's clauses
+	std::vector<LaneState> m_lanes;
+};
+
+/**
+ * @class TimerWheel
+ * @brief Hierarchical timing wheel: LEVELS wheels of SLOTS slots, level l covering
+ *        SLOTS^(l+1) ticks. Timers are pooled nodes on intrusive slot lists, so arm and
+ *        cancel are O(1) with no allocation once the pool has grown. Nothing runs between
+ *        ticks; each tick fires one level-0 slot and, every SLOTS^l ticks, cascades one
+ *        level-l slot down to the finer wheels.
+ */
+class TimerWheel {
+public:
+	static constexpr uint8_t SLOT_BITS {6};
+	static constexpr size_t SLOTS {size_t {1} << SLOT_BITS};
+	static constexpr uint8_t LEVELS {4};
+	static constexpr uint64_t HORIZON {uint64_t {1} << (SLOT_BITS * LEVELS)}; // Longer delays are re-cascaded
+
+	/**
+	 * @brief Schedules `payload` to fire `delay` ticks from now (at least one)
+	 * @return handle for cancel, never 0
+	 */
+	uint64_t arm(uint64_t delay, uint64_t payload) {
+		uint32_t index;
+		if (m_free != NONE) {
+			index = m_free;
+			m_free = m_nodes[index].next;
+		} else {
+			index = m_nodes.size();
+			m_nodes.emplace_back();
+		}
+		Node &node = m_nodes[index];
+		node.expiry = m_now + std::max<uint64_t>(delay, 1);
+		node.payload = payload;
+		node.armed = true;
+		link(index);
+		return static_cast<uint64_t>(node.generation) << 32 | index;
+	}
+
+	/**
+	 * @return false if the timer already fired or was cancelled
+	 */
+	bool cancel(uint64_t handle) {
+		uint32_t index = handle & 0xffffffff;
+		if (index >= m_nodes.size() || !m_nodes[index].armed || m_nodes[index].generation != handle >> 32) {
+			return false;
+		}
+		unlink(index);
+		release(index);
+		return true;
+	}
+
+	/**
+	 * @brief Advances one tick and calls `fire(payload)` for every timer due now.
+	 *        Callbacks may arm and cancel timers, including ones due this tick that
+	 *        have not fired yet, which then do not fire.
+	 */
+	template <typename Fire>
+	void tick(Fire fire) {
+		m_now++;
+		for (uint8_t level = 1; level < LEVELS && (m_now & ((uint64_t {1} << (SLOT_BITS * level)) - 1)) == 0; level++) {
+			uint32_t index = detach(level, m_now >> (SLOT_BITS * level) & (SLOTS - 1));
+			while (index != NONE) {
+				uint32_t next = m_nodes[index].next;
+				link(index);
+				index = next;
+			}
+		}
+		m_firing = detach(0, m_now & (SLOTS - 1));
+		while (m_firing != NONE) {
+			uint32_t index = m_firing;
+			unlink(index);
+			uint64_t payload = m_nodes[index].payload;
+			release(index);
+			fire(payload);
+		}
+	}
+
+	uint64_t now() const {
+		return m_now;
+	}
+
+private:
+	static constexpr uint32_t NONE {std::numeric_limits<uint32_t>::max()};
+
+	struct Node {
+		uint64_t expiry {0};
+		uint64_t payload {0};
+		uint32_t prev {NONE};
+		uint32_t next {NONE}; // Next on the slot list, or on the free list
+		uint32_t generation {1}; // Bumped on release so stale handles miss
+		uint16_t slot {0}; // Index into m_slots while armed
+		bool armed {false};
+	};
+
+	uint64_t m_now {0};
+	std::vector<Node> m_nodes;
+	std::array<uint32_t, LEVELS * SLOTS> m_slots = [] {
+		std::array<uint32_t, LEVELS * SLOTS> slots {};
+		slots.fill(NONE);
+		return slots;
+	}();
+	uint32_t m_free {NONE};
+	uint32_t m_firing {NONE}; // Head of the list due this tick, while tick() fires it
+
+	/**
+	 * @brief Puts a node on the coarsest level its remaining delay needs
+	 */
+	void link(uint32_t index) {
+		Node &node = m_nodes[index];
+		uint64_t expiry = std::min(node.expiry, m_now + HORIZON - 1);
+		uint8_t level = 0;
+		while (level < LEVELS - 1 && expiry - m_now >= uint64_t {1} << (SLOT_BITS * (level + 1))) {
+			level++;
+		}
+		node.slot = level * SLOTS + (expiry >> (SLOT_BITS * level) & (SLOTS - 1));
+		uint32_t &head = m_slots[node.slot];
+		node.prev = NONE;
+		node.next = head;
+		if (head != NONE) {
+			m_nodes[head].prev = index;
+		}
+		head = index;
+	}
+
+	void unlink(uint32_t index) {
+		Node &node = m_nodes[index];
+		if (node.next != NONE) {
+			m_nodes[node.next].prev = node.prev;
+		}
+		if (node.prev != NONE) {
+			m_nodes[node.prev].next = node.next;
+		} else if (index == m_firing) {
+			m_firing = node.next;
+		} else {
+			m_slots[node.slot] = node.next;
+		}
+	}
+
+	uint32_t detach(uint8_t level, uint64_t slot) {
+		uint32_t &head = m_slots[level * SLOTS + slot];
+		uint32_t index = head;
+		head = NONE;
+		return index;
+	}
+
+	void release(uint32_t index) {
+		Node &node = m_nodes[index];
+		node.armed = false;
+		node.generation++;
+		node.next = m_free;
+		m_free = index;
+	}
+};
+
+/**
+ * @class LaneTimeouts
+ * @brief Idle-lane expiry for StandingQueries: every accepted roll re-arms the lane's
+ *        timer, and a lane left idle for `idleTicks` ticks is abandoned, finalizing any
+ *        game stopped mid-frame. The event loop calls tick() once per tick.
+ */
+class LaneTimeouts {
+public:
+	LaneTimeouts(StandingQueries &lanes, uint64_t idleTicks) : m_lanes(lanes), m_idleTicks(idleTicks) {}
+
+	/**
+	 * @brief StandingQueries::roll, restarting the lane's idle timer if the roll is accepted
+	 */
+	bool roll(size_t lane, uint8_t pins, std::vector<Alert> &alerts) {
+		if (!m_lanes.roll(lane, pins, alerts)) {
+			return false;
+		}
+		if (lane >= m_timers.size()) {
+			m_timers.resize(lane + 1, 0);
+		}
+		m_wheel.cancel(m_timers[lane]);
+		m_timers[lane] = m_wheel.arm(m_idleTicks, lane);
+		return true;
+	}
+
+	/**
+	 * @brief Advances one tick, calling `abandoned(lane, score)` for each game it finalizes
+	 */
+	template <typename Abandoned>
+	void tick(Abandoned abandoned) {
+		m_wheel.tick([&](uint64_t lane) {
+			m_timers[lane] = 0;
+			int score = m_lanes.abandon(lane);
+			if (score >= 0) {
+				abandoned(static_cast<size_t>(lane), score);
+			}
+		});
+	}
+
+private:
+	StandingQueries &m_lanes;
+	uint64_t m_idleTicks;
+	TimerWheel m_wheel;
+	std::vector<uint64_t> m_timers; // Per lane, 0 when no timer is armed
+};
+
+enum class Admission : uint8_t {
+	Accepted,
+	Duplicate, // Sequence number already seen on the lane
+	Invalid, // More pins than are standing
+	Throttled, // Shed without a look while the lane was over its junk or roll budget
+	Count
+};
+
+/**
+ * @class RollAdmission
+ * @brief Admission control in front of LaneTimeouts for sequenced roll events. Duplicate
+ *        and invalid events are dropped and charged to the lane's junk bucket (BURST
+ *        tokens, refilled at `junkPerTick`). A lane that empties it is storming, and until
+ *        it refills its stale events are shed as Throttled, so a faulty pinsetter costs one
+ *        compare per event and does not touch the other lanes. Events with a new sequence
+ *        number are validated, in O(1), and draw on a second bucket (ROLL_BURST, refilled
+ *        at `rollsPerTick`) that caps a pinsetter spamming fresh numbers; set well above
+ *        the rate a lane can physically bowl, it never sheds a real roll. Counters per
+ *        lane and outcome.
+ */
+class RollAdmission {
+public:
+	static constexpr double BURST {32};
+	static constexpr double ROLL_BURST {MAX_ROLLS}; // A whole game at once, e.g. replayed after a reconnect
+
+	RollAdmission(LaneTimeouts &lanes, double junkPerTick, double rollsPerTick) :
+			m_lanes(lanes), m_junkPerTick(junkPerTick), m_rollsPerTick(rollsPerTick) {}
+
+	/**
+	 * @param sequence the pinsetter's event number for the lane, increasing from 1; gaps are allowed
+	 * @param now current tick, non-decreasing
+	 */
+	Admission submit(size_t lane, uint32_t sequence, uint8_t pins, uint64_t now, std::vector<Alert> &alerts) {
+		if (lane >= m_states.size()) {
+			m_states.resize(lane + 1, LaneState {0, BURST, ROLL_BURST, now, {}});
+		}
+		LaneState &state = m_states[lane];
+		if (now != state.refilled) { // A storm's events mostly share the tick and skip the refill
+			state.tokens = tokens(state, now);
+			state.rolls = rolls(state, now);
+			state.refilled = now;
+		}
+
+		Admission outcome = Admission::Accepted;
+		if (sequence <= state.sequence) {
+			outcome = state.tokens < 1 ? Admission::Throttled : Admission::Duplicate;
+		} else if (state.rolls < 1) {
+			outcome = Admission::Throttled; // Left unseen, so a resend after the storm still lands
+		} else {
+			state.rolls--;
+			state.sequence = sequence; // Seen, whether or not the roll is valid
+			if (!m_lanes.roll(lane, pins, alerts)) {
+				outcome = Admission::Invalid;
+			}
+		}
+		if (outcome == Admission::Duplicate || outcome == Admission::Invalid) {
+			state.tokens = std::max(0.0, state.tokens - 1);
+		}
+		state.counts[static_cast<size_t>(outcome)]++;
+		return outcome;
+	}
+
+	uint64_t count(size_t lane, Admission outcome) const {
+		return lane < m_states.size() ? m_states[lane].counts[static_cast<size_t>(outcome)] : 0;
+	}
+
+	/**
+	 * @brief Lanes still over their junk or roll budget at tick `now`, for overload metrics
+	 */
+	size_t storming(uint64_t now) const {
+		return std::count_if(m_states.begin(), m_states.end(), [&](const LaneState &state) {
+			return tokens(state, now) < 1 || rolls(state, now) < 1;
+		});
+	}
+
+private:
+	struct LaneState {
+		uint32_t sequence; // Highest seen
+		double tokens; // As of `refilled`
+		double rolls; // New sequence numbers left, as of `refilled`
+		uint64_t refilled;
+		std::array<uint64_t, static_cast<size_t>(Admission::Count)> counts;
+	};
+
+	LaneTimeouts &m_lanes;
+	double m_junkPerTick;
+	double m_rollsPerTick;
+	std::vector<LaneState> m_states;
+
+	double tokens(const LaneState &state, uint64_t now) const {
+		return std::min(BURST, state.tokens + (now - state.refilled) * m_junkPerTick);
+	}
+
+	double rolls(const LaneState &state, uint64_t now) const {
+		return std::min(ROLL_BURST, state.rolls + (now - state.refilled) * m_rollsPerTick);
+	}
+};
+
+/**
+ * @brief Pins the calling thread to one CPU, so a spinning shard keeps its core and its cache
+ * @return false where pinning is unsupported or the CPU does not exist
+ */
+bool pinThisThread(unsigned cpu) {
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu % CPU_SETSIZE, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+/**
+ * @brief A roll event as a pinsetter connection delivers it
+ */
+struct RollEvent {
+	uint32_t lane;
+	uint32_t sequence;
+	uint8_t pins;
+	uint64_t tick; // Sender's clock, the shard catches up to it before scoring
+	uint64_t stamp; // Opaque to the shard, e.g. the send time for latency
+};
+
+/**
+ * @brief How a shard waits for its next event
+ */
+enum class PollMode : uint8_t {
+	Blocking, // Sleep until the producer wakes it, like epoll_wait (default)
+	BusySpin // Spin on the ring, trading a whole (pinned) core for wake-up latency
+};
+
+/**
+ * @class EventRing
+ * @brief Bounded single-producer single-consumer ring carrying one connection's roll events
+ *        to the shard that owns its lanes. push() and the spin path of pop() are lock-free.
+ *        In Blocking mode an empty ring puts the consumer to sleep, and the producer only
+ *        takes the lock to wake it when it is actually asleep.
+ */
+class EventRing {
+public:
+	static constexpr size_t CAPACITY {1024}; // Power of two
+
+	explicit EventRing(PollMode mode) : m_mode(mode) {}
+
+	/**
+	 * @return false, dropping nothing, if the ring is full: the buffer is bounded and the
+	 *         caller decides whether to retry or shed
+	 */
+	bool push(const RollEvent &event) {
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == CAPACITY) {
+			return false;
+		}
+		m_events[tail % CAPACITY] = event;
+		m_tail.store(tail + 1); // Sequentially consistent with the m_sleeping load in wake()
+		wake(false);
+		return true;
+	}
+
+	/**
+	 * @brief Producer side: no more events, pop() returns false once the ring is drained
+	 */
+	void close() {
+		m_closed = true;
+		wake(true);
+	}
+
+	/**
+	 * @brief Waits for the next event as the mode says
+	 * @return false once the ring is closed and drained
+	 */
+	bool pop(RollEvent &event) {
+		size_t head = m_head.load(std::memory_order_relaxed);
+		while (head == m_tail.load(std::memory_order_acquire)) {
+			if (m_closed && head == m_tail.load()) {
+				return false;
+			}
+			if (m_mode == PollMode::BusySpin) {
+#ifdef __SSE2__
+				_mm_pause();
+#endif
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(m_wakeLock);
+			m_sleeping = true; // Seen by a later push(), or this wait sees that push
+			m_wake.wait(lock, [&] { return head != m_tail.load() || m_closed; });
+			m_sleeping = false;
+		}
+		event = m_events[head % CAPACITY];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::array<RollEvent, CAPACITY> m_events;
+	alignas(64) std::atomic<size_t> m_head {0}; // Next to pop, written by the consumer only
+	alignas(64) std::atomic<size_t> m_tail {0}; // Next to push, written by the producer only
+	alignas(64) std::atomic<bool> m_sleeping {false};
+	std::atomic<bool> m_closed {false};
+	std::mutex m_wakeLock;
+	std::condition_variable m_wake;
+	PollMode m_mode;
+
+	void wake(bool always) {
+		if (m_mode == PollMode::Blocking && (always || m_sleeping)) {
+			std::lock_guard<std::mutex> lock(m_wakeLock);
+			m_wake.notify_one();
+		}
+	}
+};
+
+/**
+ * @brief Center-wide counters, kept per shard and summed across shards
+ */
+struct LaneTotals {
+	uint64_t events {0};
+	uint64_t alerts {0};
+	uint64_t abandoned {0}; // Games finalized by idle timeouts
+	uint64_t abandonedScore {0};
+	std::array<uint64_t, static_cast<size_t>(Admission::Count)> outcomes {};
+
+	void merge(const LaneTotals &other) {
+		events += other.events;
+		alerts += other.alerts;
+		abandoned += other.abandoned;
+		abandonedScore += other.abandonedScore;
+		for (size_t o = 0; o < outcomes.size(); o++) {
+			outcomes[o] += other.outcomes[o];
+		}
+	}
+};
+
+/**
+ * @class LaneShard
+ * @brief One core's lanes, each with its game, timer and admission state: StandingQueries
+ *        behind LaneTimeouts behind RollAdmission. Only the thread serving the shard touches
+ *        it, so nothing is locked. Lanes keep their center-wide ids; the shard stores lane
+ *        `lane` at lane / shards, keeping its tables dense.
+ */
+class alignas(64) LaneShard {
+public:
+	LaneShard(unsigned index, unsigned shards, const std::vector<std::vector<Condition>> &queries,
+	          uint64_t idleTicks, double junkPerTick, double rollsPerTick) :
+			m_index(index), m_shards(shards), m_timeouts(m_queries, idleTicks),
+			m_admission(m_timeouts, junkPerTick, rollsPerTick) {
+		for (const auto &conditions : queries) {
+			m_queries.add(conditions);
+		}
+	}
+
+	LaneShard(const LaneShard &) = delete; // The stack holds references into itself
+	LaneShard &operator=(const LaneShard &) = delete;
+
+	bool owns(size_t lane) const {
+		return lane % m_shards == m_index;
+	}
+
+	/**
+	 * @brief RollAdmission::submit for a lane this shard owns, at the shard's current tick
+	 */
+	Admission submit(size_t lane, uint32_t sequence, uint8_t pins) {
+		m_alerts.clear();
+		Admission outcome = m_admission.submit(lane / m_shards, sequence, pins, m_now, m_alerts);
+		for (auto &alert : m_alerts) {
+			alert.lane = alert.lane * m_shards + m_index;
+		}
+		m_totals.events++;
+		m_totals.alerts += m_alerts.size();
+		m_totals.outcomes[static_cast<size_t>(outcome)]++;
+		return outcome;
+	}
+
+	/**
+	 * @brief Alerts raised by the last submit(), with center-wide lane ids
+	 */
+	const std::vector<Alert> &alerts() const {
+		return m_alerts;
+	}
+
+	/**
+	 * @brief Advances the shard's clock one tick, abandoning idle lanes
+	 */
+	void tick() {
+		m_now++;
+		m_timeouts.tick([&](size_t, int score) {
+			m_totals.abandoned++;
+			m_totals.abandonedScore += score;
+		});
+	}
+
+	uint64_t now() const {
+		return m_now;
+	}
+
+	/**
+	 * @brief Event loop: scores events from `ring` until it is closed and drained, catching
+	 *        the clock up to each event's tick first, and calls served(event) after each,
+	 *        on the serving thread
+	 */
+	template <typename Served>
+	void serve(EventRing &ring, Served served) {
+		RollEvent event;
+		while (ring.pop(event)) {
+			while (m_now < event.tick) {
+				tick();
+			}
+			submit(event.lane, event.sequence, event.pins);
+			served(event);
+		}
+	}
+
+	const LaneTotals &totals() const {
+		return m_totals;
+	}
+
+private:
+	unsigned m_index;
+	unsigned m_shards;
+	StandingQueries m_queries;
+	LaneTimeouts m_timeouts;
+	RollAdmission m_admission;
+	uint64_t m_now {0};
+	std::vector<Alert> m_alerts;
+	LaneTotals m_totals;
+};
+
+/**
+ * @class ShardedLanes
+ * @brief Shard-per-core live scoring: lane l belongs to shard l % shards, and run() serves
+ *        every shard on its own thread, which handles that shard's lanes (their connections,
+ *        games and timers) to completion. Threads share nothing while they run; center-wide
+ *        aggregates are the only cross-core traffic, summed from the shards' counters by
+ *        totals() once run() returns.
+ */
+class ShardedLanes {
+public:
+	ShardedLanes(unsigned shards, const std::vector<std::vector<Condition>> &queries, uint64_t idleTicks,
+	             double junkPerTick, double rollsPerTick) {
+		shards = std::max(1u, shards);
+		for (unsigned s = 0; s < shards; s++) {
+			m_shards.push_back(std::make_unique<LaneShard>(s, shards, queries, idleTicks, junkPerTick, rollsPerTick));
+		}
+	}
+
+	unsigned shards() const {
+		return m_shards.size();
+	}
+
+	/**
+	 * @brief Calls serve(shard, index) on one thread per shard and waits for all of them
+	 */
+	template <typename Serve>
+	void run(Serve serve) {
+		parallelFor(m_shards.size(), [&](unsigned s) {
+			serve(*m_shards[s], s);
+		});
+	}
+
+	/**
+	 * @brief run() with each shard serving its own ring until that ring is closed. With
+	 *        `pin`, shard s is pinned to CPU s + 1, leaving CPU 0 to the producers.
+	 */
+	template <typename Served>
+	void serve(std::vector<std::unique_ptr<EventRing>> &rings, bool pin, Served served) {
+		run([&](LaneShard &shard, unsigned s) {
+			if (pin) {
+				pinThisThread((s + 1) % std::max(1u, std::thread::hardware_concurrency()));
+			}
+			shard.serve(*rings[s], served);
+		});
+	}
+
+	LaneTotals totals() const {
+		LaneTotals totals;
+		for (const auto &shard : m_shards) {
+			totals.merge(shard->totals());
+		}
+		return totals;
+	}
+
+private:
+	std::vector<std::unique_ptr<LaneShard>> m_shards;
+};
+
+
+
+/**
+ * @brief Helper function to validate user input
+ */
+uint8_t getValidatedInput(const std::string &prompt) {
+	int pins;
+	while (true) {
+		std::cout << prompt;
+		std::cin >> pins;
+
+		if (std::cin.fail() || pins < 0 || pins > PINS) {
+			std::cin.clear();
+			std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+			std::cerr << "Invalid input! Enter a number between 0 and 10.\n";
+		} else {
+			return static_cast<uint8_t>(pins);
+		}
+	}
+}
+
+/**
+ * @brief Prompts until the game accepts the roll
+ */
+uint8_t rollValidatedInput(BowlingGame &game, const std::string &prompt) {
+	while (true) {
+		uint8_t pins = getValidatedInput(prompt);
+		if (game.roll(pins)) {
+			return pins;
+		}
+		std::cerr << "Invalid input! Not that many pins are standing.\n";
+	}
+}
+
+/**
+ * @brief Process user input for the bowling game.
+ */
+void processUserInput(BowlingGame &game) {
+	uint8_t frameCount = 0;
+
+	while (frameCount < FRAMES) {
+		std::cout << "-----> Roll for frame " << static_cast<int>(frameCount + 1) << std::endl;
+
+		uint8_t firstRoll = rollValidatedInput(game, "Enter Roll 1: ");
+
+		if (frameCount == FRAMES - 1) {  // 10th frame logic
+			std::string prompt = (firstRoll == PINS) ? "Enter Extra Roll: " : "Enter Roll 2: ";
+			uint8_t secondRoll;
+			secondRoll = rollValidatedInput(game, prompt);
+
+
+			if (firstRoll == PINS || firstRoll + secondRoll == PINS) {  // Strike or Spare
+				rollValidatedInput(game, "Enter Extra Roll: ");
+			}
+			return;
+		}
+
+		if (firstRoll == PINS) {  // Strike, move to next frame
+			frameCount++;
+			continue;
+		}
+
+		rollValidatedInput(game, "Enter Roll 2: ");
+
+		frameCount++;
+	}
+}
+
+
+#ifdef BENCHMARK
+constexpr size_t BENCH_GAMES {2000}; // Games per corpus
+constexpr size_t BENCH_LANES {64}; // Lanes in the admission load test
+constexpr size_t BENCH_SHARDED_LANES {4096}; // Lanes in the shard-per-core scaling test
+constexpr unsigned BENCH_MAX_SHARDS {64};
+constexpr uint64_t BENCH_IDLE_TICKS {4 * MAX_ROLLS}; // Idle timeout of the lane load tests
+constexpr double BENCH_ROLLS_PER_TICK {4}; // Roll budget refill there, four times the stand-ins' one ball per tick
+constexpr size_t BENCH_LATENCY_EVENTS {500}; // Paced events per roll-to-board latency sample
+constexpr int BENCH_PACE_US {50}; // Gap between those events, so each one finds the shard idle
+constexpr size_t BENCH_PATTERN_GAMES {4000}; // Sampled games per target in the regex cross-check
+constexpr uint32_t BENCH_TIMER_STEPS {200000}; // Ticks of random arms and cancels in the timer wheel check
+constexpr size_t BENCH_RUNS {20}; // Timed repetitions per measurement
+constexpr double BENCH_SAMPLE_NS {5e6}; // Minimum duration of one timed sample
+constexpr double BENCH_T_95 {2.093}; // Student t, 95% two-sided, BENCH_RUNS - 1 degrees of freedom
+
+using GameCorpus = std::vector<std::vector<uint8_t>>;
+
+/**
+ * @brief Appends one frame of a realistic game: strikes ~35%, spares converted ~50%
+ */
+void rollRealisticFrame(std::vector<uint8_t> &rolls, std::mt19937 &rng, bool tenth) {
+	std::uniform_int_distribution<int> percent(0, 99);
+	auto ball = [&](uint8_t standing) -> uint8_t {
+		if (percent(rng) < (standing == PINS ? 35 : 50)) {
+			return standing;
+		}
+		return standing == 0 ? 0 : std::uniform_int_distribution<int>(standing * 6 / 10, standing - 1)(rng);
+	};
+	uint8_t r1 = ball(PINS);
+	rolls.push_back(r1);
+	if (r1 == PINS && !tenth) {
+		return;
+	}
+	uint8_t r2 = ball(r1 == PINS ? PINS : PINS - r1);
+	rolls.push_back(r2);
+	if (tenth && (r1 == PINS || r1 + r2 == PINS)) {
+		rolls.push_back(ball((r1 == PINS && r2 != PINS) ? PINS - r2 : PINS));
+	}
+}
+
+/**
+ * @brief Builds the standard corpora: perfect game, all spares, random realistic, pathological
+ */
+std::vector<std::pair<std::string, GameCorpus>> benchmarkCorpora() {
+	std::mt19937 rng(2024);
+	GameCorpus perfect(BENCH_GAMES, std::vector<uint8_t>(FRAMES + 2, PINS));
+	GameCorpus spares(BENCH_GAMES, std::vector<uint8_t>(2 * FRAMES + 1, 5));
+	GameCorpus realistic(BENCH_GAMES), pathological(BENCH_GAMES);
+
+	for (auto &rolls : realistic) {
+		for (uint8_t f = 0; f < FRAMES; f++) {
+			rollRealisticFrame(rolls, rng, f == FRAMES - 1);
+		}
+	}
+	// Unpredictable strike/spare/open mix, cut off at a random roll to cover partial games
+	for (auto &rolls : pathological) {
+		for (uint8_t f = 0; f < FRAMES; f++) {
+			uint8_t r1 = std::uniform_int_distribution<int>(0, PINS)(rng);
+			rolls.push_back(r1);
+			if (r1 != PINS || f == FRAMES - 1) {
+				rolls.push_back(std::uniform_int_distribution<int>(0, r1 == PINS ? PINS : PINS - r1)(rng));
+			}
+		}
+		rolls.resize(std::uniform_int_distribution<size_t>(1, rolls.size())(rng));
+	}
+	return {{"perfect", perfect}, {"spares", spares}, {"realistic", realistic}, {"pathological", pathological}};
+}
+
+/**
+ * @class NullBuffer
+ * @brief Discards everything written, so displayBoard can be timed without a terminal
+ */
+class NullBuffer : public std::streambuf {
+protected:
+	int overflow(int c) override {
+		return c;
+	}
+	std::streamsize xsputn(const char *, std::streamsize n) override {
+		return n;
+	}
+};
+
+/**
+ * @brief Mean and 95% confidence half-width of one measurement, in ns per game
+ */
+struct BenchmarkResult {
+	double mean;
+	double ci;
+	const char *unit {"ns/game"};
+};
+
+volatile int benchmarkSink; // Keeps the optimizer from dropping scored results
+
+/**
+ * @brief Sums `loops` calls of `timed`, each returning the nanoseconds of the part it times
+ */
+template <typename Timed>
+double timeLoops(size_t loops, Timed &timed) {
+	double elapsed = 0;
+	for (size_t l = 0; l < loops; l++) {
+		elapsed += timed();
+	}
+	return elapsed;
+}
+
+/**
+ * @brief Warms up, and grows the loop count until one sample is long enough to rise above timer noise
+ */
+template <typename Timed>
+size_t calibrateLoops(Timed &timed) {
+	size_t loops = 1;
+	while (timeLoops(loops, timed) < BENCH_SAMPLE_NS) {
+		loops *= 2;
+	}
+	return loops;
+}
+
+BenchmarkResult summarize(const std::vector<double> &samples) {
+	double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+	double variance = 0;
+	for (double s : samples) {
+		variance += (s - mean) * (s - mean);
+	}
+	variance /= samples.size() - 1;
+	return {mean, BENCH_T_95 * std::sqrt(variance / samples.size())};
+}
+
+/**
+ * @brief Runs `timed` BENCH_RUNS times over a corpus and reports ns per game, where each
+ *        call returns the nanoseconds spent in the part it times itself
+ */
+template <typename Timed>
+BenchmarkResult measureTimed(size_t games, Timed timed) {
+	size_t loops = calibrateLoops(timed);
+	std::vector<double> samples;
+	for (size_t run = 0; run < BENCH_RUNS; run++) {
+		samples.push_back(timeLoops(loops, timed) / (loops * games));
+	}
+	return summarize(samples);
+}
+
+/**
+ * @brief Times `body` BENCH_RUNS times over a corpus and reports ns per game
+ */
+template <typename Body>
+BenchmarkResult measure(size_t games, Body body) {
+	return measureTimed(games, [&] {
+		auto start = std::chrono::steady_clock::now();
+		body();
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	});
+}
+
+enum class Storm : uint8_t {
+	None,
+	Stale, // Lane 0 keeps resending its first event
+	Faulty, // Lane 0's pinsetter sends 0-pin rolls under ever new sequence numbers
+};
+
+/**
+ * @brief One tick's arrivals on BENCH_LANES lanes, in one stream: lanes 1 and up each bowl
+ *        ball `round % MAX_ROLLS` of their corpus game, with sequence number round + 1, and
+ *        in a storm lane 0 sends a junk event after every other lane's turn
+ */
+void laneArrivals(std::vector<RollEvent> &arrivals, const GameCorpus &corpus, uint32_t round, Storm storm) {
+	arrivals.clear();
+	uint32_t r = round % MAX_ROLLS;
+	for (uint32_t lane = 1; lane < BENCH_LANES; lane++) {
+		if (r < corpus[lane].size()) {
+			arrivals.push_back({lane, round + 1, corpus[lane][r], round, 0});
+		}
+		if (storm == Storm::Stale) {
+			arrivals.push_back({0, 1, PINS, round, 0});
+		} else if (storm == Storm::Faulty) {
+			arrivals.push_back({0, static_cast<uint32_t>(round * BENCH_LANES + lane), 0, round, 0});
+		}
+	}
+}
+
+/**
+ * @brief Local pinsetter stand-in for one shard's lanes: each bowls `games` corpus games back
+ *        to back, one ball per tick and the next game after MAX_ROLLS ticks, optionally
+ *        resending every 7th event; then the lanes idle until their timeouts have fired
+ */
+void bowlStandIn(LaneShard &shard, unsigned index, unsigned shards, size_t lanes, const GameCorpus &corpus,
+                 uint32_t games, bool resend) {
+	for (uint32_t round = 0; round < games * MAX_ROLLS; round++) {
+		uint32_t game = round / MAX_ROLLS, r = round % MAX_ROLLS;
+		for (size_t lane = index; lane < lanes; lane += shards) {
+			const auto &rolls = corpus[(lane + game) % corpus.size()];
+			if (r < rolls.size()) {
+				shard.submit(lane, round + 1, rolls[r]);
+			}
+			if (resend && (lane + round) % 7 == 0) {
+				shard.submit(lane, round + 1, PINS);
+			}
+		}
+		shard.tick();
+	}
+	for (uint64_t t = 0; t <= BENCH_IDLE_TICKS; t++) {
+		shard.tick();
+	}
+}
+
+/**
+ * @brief Sends the stand-in's events through one ring per shard from the calling thread,
+ *        the way bowlStandIn() plays them, retrying while a ring is full
+ */
+template <typename Pace>
+void feedStandIn(std::vector<std::unique_ptr<EventRing>> &rings, size_t lanes, const GameCorpus &corpus,
+                 uint32_t games, bool resend, Pace pace) {
+	auto send = [&](RollEvent event) {
+		pace(event);
+		while (!rings[event.lane % rings.size()]->push(event)) {
+			std::this_thread::yield();
+		}
+	};
+	for (uint32_t round = 0; round < games * MAX_ROLLS; round++) {
+		uint32_t game = round / MAX_ROLLS, r = round % MAX_ROLLS;
+		for (size_t lane = 0; lane < lanes; lane++) {
+			const auto &rolls = corpus[(lane + game) % corpus.size()];
+			if (r < rolls.size()) {
+				send({static_cast<uint32_t>(lane), round + 1, rolls[r], round, 0});
+			}
+			if (resend && (lane + round) % 7 == 0) {
+				send({static_cast<uint32_t>(lane), round + 1, PINS, round, 0});
+			}
+		}
+	}
+	for (auto &ring : rings) {
+		ring->close();
+	}
+}
+
+/**
+ * @brief Roll-to-board latency of one shard fed through an EventRing: a producer thread
+ *        sends BENCH_LATENCY_EVENTS paced events stamped with their send time, and the
+ *        shard notes when each one is scored
+ * @return median and 99th percentile over the events of each of BENCH_RUNS runs, in ns
+ */
+std::pair<BenchmarkResult, BenchmarkResult> measureRollLatency(PollMode mode, const GameCorpus &corpus) {
+	auto nowNs = [] {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	};
+	std::vector<double> medians, tails, latencies;
+	for (size_t run = 0; run < BENCH_RUNS; run++) {
+		ShardedLanes center(1, {{{GameField::MaxPossible, Compare::Equal, MAX_SCORE}}}, BENCH_IDLE_TICKS, 1,
+		                    BENCH_ROLLS_PER_TICK);
+		std::vector<std::unique_ptr<EventRing>> rings;
+		rings.push_back(std::make_unique<EventRing>(mode));
+		latencies.clear();
+		std::thread producer([&] {
+			if (mode == PollMode::BusySpin) {
+				pinThisThread(0);
+			}
+			size_t sent = 0; // Paced up to BENCH_LATENCY_EVENTS, then the games are sent out
+			feedStandIn(rings, BENCH_LANES, corpus, 1, false, [&](RollEvent &event) {
+				std::this_thread::sleep_for(std::chrono::microseconds(sent++ < BENCH_LATENCY_EVENTS ? BENCH_PACE_US : 0));
+				event.stamp = nowNs();
+			});
+		});
+		center.serve(rings, mode == PollMode::BusySpin, [&](const RollEvent &event) {
+			if (latencies.size() < BENCH_LATENCY_EVENTS) {
+				latencies.push_back(nowNs() - event.stamp);
+			}
+		});
+		producer.join();
+		std::sort(latencies.begin(), latencies.end());
+		medians.push_back(latencies[latencies.size() / 2]);
+		tails.push_back(latencies[latencies.size() * 99 / 100]);
+	}
+	BenchmarkResult median = summarize(medians), tail = summarize(tails);
+	median.unit = tail.unit = "ns";
+	return {median, tail};
+}
+
+/**
+ * @brief Runs every engine path over every corpus
+ * @return results keyed by "engine/path/corpus"
+ */
+std::map<std::string, BenchmarkResult> runBenchmarks() {
+	std::map<std::string, BenchmarkResult> results;
+	NullBuffer nullBuffer;
+
+	for (const auto &[name, corpus] : benchmarkCorpora()) {
+		std::vector<BowlingGame> games(corpus.size());
+		std::vector<BowlingGame> prefixes(corpus.size()); // Games in progress, for the live-game paths
+		for (size_t g = 0; g < corpus.size(); g++) {
+			for (size_t r = 0; r < corpus[g].size(); r++) {
+				games[g].roll(corpus[g][r]);
+				if (r < g % corpus[g].size()) {
+					prefixes[g].roll(corpus[g][r]);
+				}
+			}
+		}
+
+		results["BowlingGame/processFrames/" + name] = measure(games.size(), [&] {
+			for (auto &game : games) {
+				game.processFrames();
+			}
+		});
+		results["BowlingGame/total/" + name] = measure(games.size(), [&] {
+			int sum = 0;
+			for (auto &game : games) {
+				sum += game.total();
+			}
+			benchmarkSink = sum;
+		});
+		results["GameBranch/fork/" + name] = measure(prefixes.size(), [&] {
+			int sum = 0;
+			for (auto &game : prefixes) {
+				GameBranch branch = game.fork();
+				branch.roll(0);
+				branch.roll(0);
+				sum += branch.total();
+			}
+			benchmarkSink = sum;
+		});
+		results["ScoreState/nextBallOutcomes/" + name] = measure(prefixes.size(), [&] {
+			int sum = 0;
+			for (auto &game : prefixes) {
+				sum += game.nextBallOutcomes().count;
+			}
+			benchmarkSink = sum;
+		});
+		results["BowlingGame/calculateScore/" + name] = measure(games.size(), [&] {
+			int sum = 0;
+			for (auto &game : games) {
+				sum += game.calculateScore();
+			}
+			benchmarkSink = sum;
+		});
+		std::streambuf *console = std::cout.rdbuf(&nullBuffer);
+		results["BowlingGame/displayBoard/" + name] = measure(games.size(), [&] {
+			for (auto &game : games) {
+				game.displayBoard();
+			}
+		});
+		std::cout.rdbuf(console);
+	}
+
+	// Checksum cost, reported per GB verified
+	std::vector<uint8_t> buffer(1 << 20);
+	std::iota(buffer.begin(), buffer.end(), 0);
+	auto perGigabyte = [&](BenchmarkResult result) {
+		double scale = 1e9 / buffer.size() / 1e6;
+		return BenchmarkResult {result.mean * scale, result.ci * scale, "ms/GB"};
+	};
+	results["crc32c/auto/1MB"] = perGigabyte(measure(1, [&] {
+		benchmarkSink = crc32c(buffer.data(), buffer.size());
+	}));
+	results["crc32c/software/1MB"] = perGigabyte(measure(1, [&] {
+		benchmarkSink = crc32cSoftware(buffer.data(), buffer.size());
+	}));
+
+	// Mean latency of a legitimate roll on BENCH_LANES - 1 lanes, from its arrival to its
+	// board, quiet and with lane 0 storming: each tick's laneArrivals() land at once and are
+	// served in order, so junk queued ahead of a roll counts. Each lane plays two games;
+	// only the second game's rolls are timed, after every table has grown.
+	GameCorpus laneGames = benchmarkCorpora()[2].second;
+	size_t laneRolls = 0;
+	for (size_t lane = 1; lane < BENCH_LANES; lane++) {
+		laneRolls += laneGames[lane].size();
+	}
+	auto playLanes = [&](Storm storm) {
+		StandingQueries queries;
+		queries.add({{GameField::MaxPossible, Compare::Equal, MAX_SCORE}, {GameField::Frame, Compare::AtLeast, 6}});
+		LaneTimeouts timeouts(queries, BENCH_IDLE_TICKS);
+		RollAdmission admission(timeouts, 1, BENCH_ROLLS_PER_TICK);
+		std::vector<RollEvent> arrivals;
+		std::vector<Alert> alerts;
+		double latency = 0;
+		for (uint32_t round = 0; round < 2 * MAX_ROLLS; round++) {
+			laneArrivals(arrivals, laneGames, round, storm);
+			auto arrived = std::chrono::steady_clock::now();
+			for (const RollEvent &event : arrivals) {
+				admission.submit(event.lane, event.sequence, event.pins, round, alerts);
+				if (event.lane != 0 && round >= MAX_ROLLS) {
+					latency += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - arrived).count();
+				}
+			}
+			timeouts.tick([](size_t, int) {});
+		}
+		benchmarkSink = alerts.size();
+		return latency;
+	};
+	// Quiet and storm samples alternate, so drift in machine load hits them alike
+	const std::pair<const char *, Storm> storms[] {
+		{"RollAdmission/quiet", Storm::None},
+		{"RollAdmission/stale", Storm::Stale},
+		{"RollAdmission/faulty", Storm::Faulty},
+	};
+	auto quiet = [&] { return playLanes(Storm::None); };
+	size_t loops = calibrateLoops(quiet);
+	std::map<std::string, std::vector<double>> laneSamples;
+	for (size_t run = 0; run < BENCH_RUNS; run++) {
+		for (const auto &[key, storm] : storms) {
+			auto play = [&, storm = storm] { return playLanes(storm); };
+			laneSamples[key].push_back(timeLoops(loops, play) / (loops * laneRolls));
+		}
+	}
+	for (const auto &[key, samples] : laneSamples) {
+		results[key] = summarize(samples);
+		results[key].unit = "ns";
+	}
+
+	// Wall-clock cost per roll of BENCH_SHARDED_LANES lanes bowling two games each, served
+	// by 1 to BENCH_MAX_SHARDS shards on as many threads; flat on a single core
+	size_t shardedRolls = 0;
+	for (size_t lane = 0; lane < BENCH_SHARDED_LANES; lane++) {
+		shardedRolls += laneGames[lane % laneGames.size()].size() + laneGames[(lane + 1) % laneGames.size()].size();
+	}
+	for (unsigned shards = 1; shards <= BENCH_MAX_SHARDS; shards *= 2) {
+		std::string key = std::string("ShardedLanes/") + (shards < 10 ? "0" : "") + std::to_string(shards);
+		results[key] = measureTimed(shardedRolls, [&] {
+			ShardedLanes center(shards, {{{GameField::MaxPossible, Compare::Equal, MAX_SCORE}, {GameField::Frame, Compare::AtLeast, 6}}},
+			                    BENCH_IDLE_TICKS, 1, BENCH_ROLLS_PER_TICK);
+			auto start = std::chrono::steady_clock::now();
+			center.run([&](LaneShard &shard, unsigned index) {
+				bowlStandIn(shard, index, shards, BENCH_SHARDED_LANES, laneGames, 2, false);
+			});
+			benchmarkSink = center.totals().alerts;
+			return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		});
+		results[key].unit = "ns/roll";
+	}
+
+	// Roll-to-board latency, the default sleeping shard against a pinned, spinning one
+	for (auto [mode, name] : {std::make_pair(PollMode::Blocking, "blocking"), std::make_pair(PollMode::BusySpin, "spin")}) {
+		auto [median, tail] = measureRollLatency(mode, laneGames);
+		results[std::string("EventRing/") + name + "/p50"] = median;
+		results[std::string("EventRing/") + name + "/p99"] = tail;
+	}
+	return results;
+}
+
+/**
+ * @brief Most pins the next roll can knock down, or -1 once the game is complete.
+ *        Walks the rolls itself so legal games are not generated by ScoreState, an engine under check.
+ */
+int nextRollLimit(const std::vector<uint8_t> &rolls) {
+	size_t i = 0;
+	for (uint8_t frame = 0; frame < FRAMES - 1; frame++) {
+		if (i == rolls.size()) {
+			return PINS;
+		}
+		if (rolls[i++] == PINS) {
+			continue;
+		}
+		if (i == rolls.size()) {
+			return PINS - rolls[i - 1];
+		}
+		i++;
+	}
+	size_t thrown = rolls.size() - i;
+	uint8_t r1 = thrown > 0 ? rolls[i] : 0, r2 = thrown > 1 ? rolls[i + 1] : 0;
+	if (thrown == 0) {
+		return PINS;
+	} else if (thrown == 1) {
+		return r1 == PINS ? PINS : PINS - r1;
+	} else if (thrown == 2 && r1 == PINS) {
+		return r2 == PINS ? PINS : PINS - r2;
+	} else if (thrown == 2 && r1 + r2 == PINS) {
+		return PINS;
+	}
+	return -1;
+}
+
+/**
+ * @brief Textbook roll-walking scorer, the reference every engine is checked against
+ */
+int referenceScore(const std::vector<uint8_t> &rolls) {
+	auto at = [&](size_t i) -> int { return i < rolls.size() ? rolls[i] : 0; };
+	int total = 0;
+	size_t i = 0;
+	for (uint8_t frame = 0; frame < FRAMES && i < rolls.size(); frame++) {
+		if (frame == FRAMES - 1) {
+			bool thirdRoll = at(i) == PINS || at(i) + at(i + 1) == PINS;
+			total += at(i) + at(i + 1) + (thirdRoll ? at(i + 2) : 0);
+		} else if (at(i) == PINS) {
+			total += BASE_SCORE + at(i + 1) + at(i + 2);
+			i += 1;
+		} else if (at(i) + at(i + 1) == BASE_SCORE) {
+			total += BASE_SCORE + at(i + 2);
+			i += 2;
+		} else {
+			total += at(i) + at(i + 1);
+			i += 2;
+		}
+	}
+	return total;
+}
+
+/**
+ * @brief A scorer under differential check. Engines reuse one game per thread, so a
+ *        check costs no more allocations than the scoring path itself makes.
+ */
+struct ScoringEngine {
+	const char *name;
+	int (*score)(const std::vector<uint8_t> &rolls);
+};
+
+std::vector<ScoringEngine> scoringEngines() {
+	return {
+		{"BowlingGame", [](const std::vector<uint8_t> &rolls) {
+			thread_local BowlingGame game;
+			game.clear();
+			for (auto r : rolls) {
+				game.roll(r);
+			}
+			game.processFrames();
+			return game.calculateScore();
+		}},
+		{"BowlingGame::total", [](const std::vector<uint8_t> &rolls) {
+			thread_local BowlingGame game;
+			game.clear();
+			for (auto r : rolls) {
+				game.roll(r);
+			}
+			return game.total();
+		}},
+		{"GameBranch", [](const std::vector<uint8_t> &rolls) {
+			thread_local BowlingGame game;
+			game.clear();
+			size_t half = rolls.size() / 2;
+			for (size_t i = 0; i < half; i++) {
+				game.roll(rolls[i]);
+			}
+			GameBranch branch = game.fork();
+			for (size_t i = half; i < rolls.size(); i++) {
+				branch.roll(rolls[i]);
+			}
+			return branch.total();
+		}},
+		{"ScoreState", [](const std::vector<uint8_t> &rolls) {
+			ScoreState state;
+			for (auto r : rolls) {
+				state.apply(r);
+			}
+			return static_cast<int>(state.total());
+		}},
+	};
+}
+
+/**
+ * @brief Name of the first engine disagreeing with referenceScore, or nullptr
+ */
+const char *firstDisagreement(const std::vector<ScoringEngine> &engines, const std::vector<uint8_t> &rolls) {
+	int expected = referenceScore(rolls);
+	for (const auto &engine : engines) {
+		if (engine.score(rolls) != expected) {
+			return engine.name;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * @brief Whether every roll knocks down no more pins than are standing, within a game's length
+ */
+bool isLegalGame(const std::vector<uint8_t> &rolls) {
+	for (size_t i = 0; i < rolls.size(); i++) {
+		if (nextRollLimit(std::vector<uint8_t>(rolls.begin(), rolls.begin() + i)) < rolls[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Shrinks a failing game to a minimal one: drop frames and rolls, then lower pins
+ */
+std::vector<uint8_t> shrinkMismatch(const std::vector<ScoringEngine> &engines, std::vector<uint8_t> rolls) {
+	for (size_t width : {2, 1}) { // A whole open frame first, then single rolls
+		for (size_t i = rolls.size(); i-- > 0;) {
+			if (i + width > rolls.size()) {
+				continue;
+			}
+			std::vector<uint8_t> shorter = rolls;
+			shorter.erase(shorter.begin() + i, shorter.begin() + i + width);
+			if (!shorter.empty() && isLegalGame(shorter) && firstDisagreement(engines, shorter)) {
+				rolls = shorter;
+			}
+		}
+	}
+	for (size_t i = 0; i < rolls.size(); i++) {
+		while (rolls[i] > 0) {
+			std::vector<uint8_t> lower = rolls;
+			lower[i]--;
+			if (!isLegalGame(lower) || !firstDisagreement(engines, lower)) {
+				break;
+			}
+			rolls = lower;
+		}
+	}
+	return rolls;
+}
+
+/**
+ * @brief Streams every legal prefix up to `depth` rolls, then `randomGames` random full
+ *        games, through all engines on every core. Reports the first mismatch, shrunk.
+ * @return number of games checked, or 0 on mismatch
+ */
+uint64_t runDifferentialCheck(size_t depth, uint64_t randomGames) {
+	const auto engines = scoringEngines();
+	const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	std::atomic<bool> failed {false};
+	std::atomic<uint64_t> checked {0};
+	std::mutex mismatchLock;
+	std::vector<uint8_t> mismatch;
+
+	auto check = [&](const std::vector<uint8_t> &rolls) {
+		if (firstDisagreement(engines, rolls) && !failed.exchange(true)) {
+			std::lock_guard<std::mutex> lock(mismatchLock);
+			mismatch = rolls;
+		}
+	};
+
+	auto worker = [&](unsigned id) {
+		uint64_t count = 0;
+		std::vector<uint8_t> rolls;
+		rolls.reserve(MAX_ROLLS);
+		// Exhaustive prefixes, split across threads by first roll; each node's limit
+		// is passed down instead of re-walking the prefix
+		auto extend = [&](auto &self, int limit) -> void {
+			check(rolls);
+			count++;
+			if (rolls.size() == depth || limit < 0 || failed) {
+				return;
+			}
+			for (int pins = 0; pins <= limit; pins++) {
+				rolls.push_back(pins);
+				self(self, nextRollLimit(rolls));
+				rolls.pop_back();
+			}
+		};
+		for (uint8_t first = id; first <= PINS; first += threads) {
+			rolls.assign(1, first);
+			extend(extend, nextRollLimit(rolls));
+		}
+
+		std::mt19937_64 rng(id);
+		for (uint64_t g = id; g < randomGames && !failed; g += threads) {
+			rolls.clear();
+			for (int limit = PINS; limit >= 0; limit = nextRollLimit(rolls)) {
+				rolls.push_back(std::uniform_int_distribution<int>(0, limit)(rng));
+			}
+			check(rolls);
+			count++;
+		}
+		checked += count;
+	};
+
+	parallelFor(threads, worker);
+
+	if (failed) {
+		auto minimal = shrinkMismatch(engines, mismatch);
+		std::cout << "MISMATCH in " << firstDisagreement(engines, minimal) << ", expected "
+		          << referenceScore(minimal) << " for rolls:";
+		for (auto r : minimal) {
+			std::cout << " " << static_cast<int>(r);
+		}
+		std::cout << "\n";
+		return 0;
+	}
+	return checked;
+}
+
+/**
+ * @brief Checks boardAt(), scoreAt() and frameStatus() against games replayed up to each roll.
+ *        A frame counts as pending n balls when, after n more gutter balls, even the best
+ *        possible rest of the game leaves its score alone.
+ * @return false after printing the first disagreement
+ */
+bool checkBoards() {
+	std::mt19937_64 rng(82);
+	for (uint32_t g = 0; g < 2000; g++) {
+		std::vector<uint8_t> rolls;
+		for (int limit = PINS; limit >= 0; limit = nextRollLimit(rolls)) { // Strikes and spares are common
+			rolls.push_back(rng() % 3 == 0 ? limit : std::uniform_int_distribution<int>(0, limit)(rng));
+		}
+		rolls.resize(rolls.size() - g % 4);
+		BowlingGame game;
+		for (auto pins : rolls) {
+			game.roll(pins);
+		}
+
+		for (size_t n = 0; n <= rolls.size() + 1; n++) {
+			BoardCheckpoint board;
+			if (n > rolls.size()) {
+				if (game.boardAt(n, board)) {
+					std::cout << "MISMATCH: boardAt past the last roll\n";
+					return false;
+				}
+				continue;
+			}
+
+			// Frame scores after 0, 1 and 2 more gutter balls, each alone and completed at best
+			auto scoresOf = [](const std::vector<uint8_t> &played) {
+				BowlingGame replay;
+				for (auto pins : played) {
+					replay.roll(pins);
+				}
+				return replay.scores();
+			};
+			std::vector<uint8_t> played(rolls.begin(), rolls.begin() + n);
+			std::array<std::vector<uint16_t>, 3> scores, settled;
+			for (uint8_t balls = 0; balls < scores.size(); balls++) {
+				if (balls > 0 && nextRollLimit(played) >= 0) {
+					played.push_back(0);
+				}
+				std::vector<uint8_t> best = played;
+				for (int limit = nextRollLimit(best); limit >= 0; limit = nextRollLimit(best)) {
+					best.push_back(limit);
+				}
+				scores[balls] = scoresOf(played);
+				settled[balls] = scoresOf(best);
+			}
+			BowlingGame prefix;
+			for (size_t r = 0; r < n; r++) {
+				prefix.roll(rolls[r]);
+			}
+
+			bool agree = game.boardAt(n, board) && board.total() == prefix.total()
+				&& board.pinsStanding() == prefix.liveState().pinsStanding();
+			for (uint8_t f = 0; f < FRAMES; f++) {
+				FrameStatus expected = FrameStatus::NotStarted;
+				for (uint8_t balls = 0; f < scores[0].size() && balls < 3; balls++) {
+					if (scores[balls][f] == settled[balls][f]) {
+						expected = static_cast<FrameStatus>(balls);
+						break;
+					}
+				}
+				uint16_t score = 0;
+				bool shown = game.scoreAt(n, f, score);
+				agree &= board.status(f) == expected && prefix.frameStatus(f) == expected
+					&& shown == (expected == FrameStatus::Final) && (!shown || score == scores[0][f]);
+			}
+			if (!agree) {
+				std::cout << "MISMATCH in the board after roll " << n << " of game " << g << "\n";
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Checks ScoreSpace against brute force: game counts per score and reachability from
+ *        late states against every completion, then that sampling at a score draws each of
+ *        that score's games evenly (chi-square) and that batches match serial draws
+ * @return false after printing the first disagreement
+ */
+bool checkScoreSpace() {
+	ScoreSpace space;
+	std::mt19937_64 rng(86);
+	auto rollsOf = [](const GameBranch &game) {
+		std::vector<uint8_t> rolls;
+		for (size_t r = 0; r < game.rollCount(); r++) {
+			rolls.push_back(game.rollAt(r));
+		}
+		return rolls;
+	};
+
+	bool agree = true;
+	for (uint32_t g = 0; g < 300 && agree; g++) { // Two frames left, a few with three
+		std::vector<uint8_t> rolls;
+		ScoreState state;
+		uint8_t fromFrame = g % 100 == 0 ? FRAMES - 3 : FRAMES - 2;
+		for (int limit = PINS; limit >= 0 && (state.frame() < fromFrame || (g % 2 && rolls.size() % 2));
+		     limit = nextRollLimit(rolls)) {
+			rolls.push_back(rng() % 3 == 0 ? limit : std::uniform_int_distribution<int>(0, limit)(rng));
+			state.apply(rolls.back());
+		}
+		ScoreSpace::ScoreCounts counts {};
+		uint64_t games = 0;
+		auto complete = [&](auto &self) -> void {
+			int limit = nextRollLimit(rolls);
+			if (limit < 0) {
+				counts[referenceScore(rolls)]++;
+				games++;
+				return;
+			}
+			for (int pins = 0; pins <= limit; pins++) {
+				rolls.push_back(pins);
+				self(self);
+				rolls.pop_back();
+			}
+		};
+		complete(complete);
+		agree = space.countGames(state) == games;
+		for (uint16_t target = 0; target <= MAX_SCORE; target++) {
+			agree &= space.countGames(state, target) == counts[target]
+				&& space.canReach(state, target) == (counts[target] > 0);
+		}
+	}
+
+	const uint16_t target = 270;
+	const uint32_t drawsPerGame = 200;
+	std::map<std::vector<uint8_t>, uint32_t> draws;
+	space.enumerate(target, [&](const GameBranch &game) {
+		agree &= game.state().complete() && referenceScore(rollsOf(game)) == target;
+		draws[rollsOf(game)] = 0;
+	});
+	agree &= draws.size() == space.countGames(ScoreState(), target);
+	for (uint32_t d = 0; d < drawsPerGame * draws.size() && agree; d++) {
+		auto drawn = draws.find(rollsOf(space.sample(rng, target)));
+		agree = drawn != draws.end();
+		if (agree) {
+			drawn->second++;
+		}
+	}
+	double chiSquare = 0, freedom = draws.size() - 1.0;
+	for (const auto &[rolls, hits] : draws) {
+		chiSquare += (hits - drawsPerGame) * (hits - drawsPerGame) / static_cast<double>(drawsPerGame);
+	}
+	agree &= chiSquare < freedom + 6 * std::sqrt(2 * freedom); // Mean and 6 standard deviations
+	for (uint32_t d = 0; d < 1000 && agree; d++) {
+		std::vector<uint8_t> rolls = rollsOf(space.sample(rng));
+		agree = isLegalGame(rolls) && nextRollLimit(rolls) < 0;
+	}
+
+	GameColumns batch;
+	const unsigned threads = 3;
+	const size_t count = 1000;
+	space.sampleBatch(batch, count, target, 7, threads);
+	for (unsigned t = 0; t < threads; t++) {
+		std::mt19937_64 serial(7 + t);
+		for (size_t g = count * t / threads; g < count * (t + 1) / threads; g++) {
+			agree &= rollsOf(batch.game(g)) == rollsOf(space.sample(serial, target)) && batch.totals[g] == target;
+		}
+	}
+	if (!agree) {
+		std::cout << "MISMATCH in ScoreSpace\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Checks StandingQueries on random queries against a model that rescores each lane's
+ *        rolls from scratch on every event, with invalid rolls and abandoned lanes mixed in
+ * @return false after printing the first disagreement
+ */
+bool checkStandingQueries() {
+	std::mt19937_64 rng(87);
+	StandingQueries queries;
+	std::vector<std::vector<Condition>> registered {
+		{{GameField::MaxPossible, Compare::Equal, 300}, {GameField::Frame, Compare::AtLeast, 6}},
+		{{GameField::StrikeStreak, Compare::AtLeast, 11}},
+		{{GameField::SeriesMaxPossible, Compare::AtLeast, 800}, {GameField::Frame, Compare::AtLeast, 1}},
+	};
+	const std::array<uint16_t, static_cast<size_t>(GameField::Count)> ranges {MAX_SCORE, MAX_SCORE, FRAMES, 15, 900, 900};
+	while (registered.size() < 40) {
+		std::vector<Condition> conditions;
+		for (uint64_t c = rng() % 3; c < 3; c++) {
+			auto field = static_cast<GameField>(rng() % ranges.size());
+			conditions.push_back({field, static_cast<Compare>(rng() % 3), static_cast<uint16_t>(rng() % (ranges[static_cast<size_t>(field)] + 1))});
+		}
+		registered.push_back(conditions);
+	}
+	for (const auto &conditions : registered) {
+		queries.add(conditions);
+	}
+
+	struct Lane {
+		std::vector<uint8_t> rolls; // Current game
+		std::vector<uint16_t> totals; // Completed games of the series
+		uint16_t streak; // Strikes are balls clearing a newly set rack
+		bool freshRack;
+		std::vector<bool> active;
+	};
+	const Lane idle {{}, {}, 0, true, std::vector<bool>(registered.size())};
+	std::vector<Lane> lanes(8, idle);
+	std::vector<Alert> alerts, expected;
+	bool agree = true;
+	for (uint32_t event = 0; event < 200000 && agree; event++) {
+		size_t l = rng() % lanes.size();
+		Lane &lane = lanes[l];
+		if (rng() % 500 == 0) {
+			agree = queries.abandon(l) == (lane.rolls.empty() ? -1 : referenceScore(lane.rolls));
+			lane = idle;
+			continue;
+		}
+		int limit = nextRollLimit(lane.rolls);
+		uint8_t pins = rng() % 50 == 0 ? limit + 1 + rng() % 5 : rng() % 3 == 0 ? limit : rng() % (limit + 1);
+		alerts.clear();
+		if (!queries.roll(l, pins, alerts)) {
+			agree = pins > limit && alerts.empty();
+			continue;
+		}
+		lane.rolls.push_back(pins);
+		lane.streak = pins == limit && lane.freshRack ? lane.streak + 1 : 0;
+		lane.freshRack = nextRollLimit(lane.rolls) < 0 || pins == limit || !lane.freshRack;
+
+		std::vector<uint8_t> best = lane.rolls;
+		for (int next = nextRollLimit(best); next >= 0; next = nextRollLimit(best)) {
+			best.push_back(next);
+		}
+		uint16_t frame = 0;
+		for (size_t r = 0; r < lane.rolls.size() && frame < FRAMES - 1; frame++) {
+			if (lane.rolls[r] != PINS && r + 1 == lane.rolls.size()) {
+				break;
+			}
+			r += lane.rolls[r] == PINS ? 1 : 2;
+		}
+		frame += frame == FRAMES - 1 && nextRollLimit(lane.rolls) < 0;
+		uint16_t completed = std::accumulate(lane.totals.begin(), lane.totals.end(), 0);
+		uint16_t total = referenceScore(lane.rolls), maxPossible = referenceScore(best);
+		const std::array<uint16_t, static_cast<size_t>(GameField::Count)> fields {
+			total, maxPossible, frame, lane.streak, static_cast<uint16_t>(completed + total),
+			static_cast<uint16_t>(completed + maxPossible + (SERIES_GAMES - 1 - lane.totals.size()) * MAX_SCORE),
+		};
+
+		expected.clear();
+		for (size_t q = 0; q < registered.size(); q++) {
+			bool match = true;
+			for (const auto &condition : registered[q]) {
+				uint16_t value = fields[static_cast<size_t>(condition.field)];
+				match &= condition.op == Compare::AtLeast ? value >= condition.value
+					: condition.op == Compare::AtMost ? value <= condition.value : value == condition.value;
+			}
+			if (match && !lane.active[q]) {
+				expected.push_back({l, q});
+			}
+			lane.active[q] = match;
+		}
+		agree = alerts.size() == expected.size() && std::equal(alerts.begin(), alerts.end(), expected.begin(),
+			[](const Alert &a, const Alert &b) { return a.lane == b.lane && a.query == b.query; });
+
+		if (nextRollLimit(lane.rolls) < 0) {
+			lane.totals.push_back(total);
+			lane.rolls.clear();
+			if (lane.totals.size() == SERIES_GAMES) {
+				lane.totals.clear();
+			}
+		}
+	}
+	if (!agree) {
+		std::cout << "MISMATCH in StandingQueries\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Checks groupScores on 1, 3 and 8 threads against sorted totals per key, with
+ *        groups on both sides of ScoreStats::SPARSE_GAMES and keys both in runs and scattered
+ * @return false after printing the first disagreement
+ */
+bool checkGroupScores() {
+	std::mt19937_64 rng(89);
+	std::vector<uint64_t> keys;
+	std::vector<uint16_t> totals;
+	for (uint32_t g = 0; g < 200000; g++) {
+		// Large groups in runs; ~1000-game groups whose partials only outgrow SPARSE_GAMES
+		// when merged; small scattered groups
+		keys.push_back(g % 10 < 7 ? g / 1000 % 5 : g % 100 == 7 ? 5 + g % 2 : rng() % 2000 + 7);
+		totals.push_back(rng() % (MAX_SCORE + 1));
+	}
+	std::map<uint64_t, std::vector<uint16_t>> sorted;
+	for (size_t g = 0; g < keys.size(); g++) {
+		sorted[keys[g]].push_back(totals[g]);
+	}
+
+	bool agree = groupScores(keys, {}, 1).empty();
+	for (unsigned threads : {1, 3, 8}) {
+		auto groups = groupScores(keys, totals, threads);
+		agree &= groups.size() == sorted.size();
+		for (auto &[key, group] : sorted) {
+			std::sort(group.begin(), group.end());
+			auto found = groups.find(key);
+			if (found == groups.end()) {
+				agree = false;
+				break;
+			}
+			const ScoreStats &stats = found->second;
+			agree &= stats.count == group.size() && stats.min == group.front() && stats.max == group.back()
+				&& stats.sum == std::accumulate(group.begin(), group.end(), uint64_t {0});
+			for (double percent : {0.1, 1.0, 25.0, 50.0, 90.0, 99.0, 100.0}) {
+				size_t rank = std::max<size_t>(1, std::ceil(percent / 100 * group.size()));
+				agree &= stats.percentile(percent) == group[rank - 1];
+			}
+		}
+	}
+	if (!agree) {
+		std::cout << "MISMATCH in groupScores\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Checks SimilarGames::nearest against a full sort of distances computed from
+ *        BowlingGame frame scores and raw rolls, on an archive with many tied games
+ * @return false after printing the first disagreement
+ */
+bool checkSimilarGames() {
+	ScoreSpace space;
+	GameColumns games, tied;
+	space.sampleBatch(games, 2000, -1, 90, 1);
+	space.sampleBatch(tied, 1000, 280, 91, 1); // Only 26 games score 280
+	games.rolls.insert(games.rolls.end(), tied.rolls.begin(), tied.rolls.end());
+	games.rollCounts.insert(games.rollCounts.end(), tied.rollCounts.begin(), tied.rollCounts.end());
+	games.totals.insert(games.totals.end(), tied.totals.begin(), tied.totals.end());
+	SimilarGames index(games);
+
+	auto frameScores = [](const GameBranch &game) {
+		BowlingGame board(game);
+		std::array<int, FRAMES> scores {};
+		const auto &running = board.scores();
+		for (size_t f = 0; f < running.size(); f++) {
+			scores[f] = running[f] - (f > 0 ? running[f - 1] : 0);
+		}
+		return scores;
+	};
+	std::vector<std::array<int, FRAMES>> archiveScores;
+	for (size_t g = 0; g < games.size(); g++) {
+		archiveScores.push_back(frameScores(games.game(g)));
+	}
+
+	std::mt19937_64 rng(90);
+	bool agree = true;
+	for (uint32_t q = 0; q < 20 && agree; q++) {
+		GameBranch query = q % 2 ? games.game(rng() % games.size()) : space.sample(rng);
+		if (q % 5 == 0) { // A game in progress
+			GameBranch partial;
+			for (size_t r = 0; r < query.rollCount() / 2; r++) {
+				partial.roll(query.rollAt(r));
+			}
+			query = partial;
+		}
+		std::array<int, FRAMES> queryScores = frameScores(query);
+		for (auto metric : {SimilarGames::Metric::FrameScoreL1, SimilarGames::Metric::RollHamming}) {
+			std::vector<SimilarGame> expected;
+			for (size_t g = 0; g < games.size(); g++) {
+				uint32_t distance = 0;
+				for (size_t i = 0; i < FRAMES && metric == SimilarGames::Metric::FrameScoreL1; i++) {
+					distance += std::abs(queryScores[i] - archiveScores[g][i]);
+				}
+				for (size_t r = 0; r < MAX_ROLLS && metric == SimilarGames::Metric::RollHamming; r++) {
+					distance += (r < query.rollCount() ? query.rollAt(r) : 0) != games.rolls[g * MAX_ROLLS + r];
+				}
+				expected.push_back({g, distance});
+			}
+			std::sort(expected.begin(), expected.end(), [](const SimilarGame &a, const SimilarGame &b) {
+				return a.distance != b.distance ? a.distance < b.distance : a.game < b.game;
+			});
+			for (size_t k : {size_t {0}, size_t {1}, size_t {10}, games.size() + 5}) {
+				for (unsigned threads : {1, 3, 8}) {
+					auto found = index.nearest(query, k, metric, threads);
+					agree &= found.size() == std::min(k, games.size())
+						&& std::equal(found.begin(), found.end(), expected.begin(), [](const SimilarGame &a, const SimilarGame &b) {
+							return a.game == b.game && a.distance == b.distance;
+						});
+				}
+			}
+		}
+	}
+	if (!agree) {
+		std::cout << "MISMATCH in SimilarGames\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Checks SortedIndex range() and lookup() against a scan of the key column, for
+ *        sizes around FENCE_STRIDE, keys repeated across many fences and keys near the top
+ *        of the range, built on 1 to 8 threads
+ * @return false after printing the first disagreement
+ */
+bool checkSortedIndex() {
+	std::mt19937_64 rng(92);
+	bool agree = true;
+	for (size_t size : {0, 1, 63, 64, 65, 1000, 100000}) {
+		std::vector<uint64_t> keys;
+		for (size_t g = 0; g < size; g++) {
+			uint64_t key = rng() % 3 == 0 ? rng() % 4 : rng() % 500;
+			keys.push_back(g % 7 == 0 ? std::numeric_limits<uint64_t>::max() - key : key);
+		}
+		auto scan = [&](uint64_t from, uint64_t to) {
+			std::vector<std::pair<uint64_t, size_t>> found;
+			for (size_t g = 0; g < keys.size(); g++) {
+				if (keys[g] >= from && keys[g] <= to) {
+					found.push_back({keys[g], g});
+				}
+			}
+			std::sort(found.begin(), found.end());
+			std::vector<size_t> games;
+			for (const auto &entry : found) {
+				games.push_back(entry.second);
+			}
+			return games;
+		};
+
+		for (unsigned threads : {1, 2, 3, 5, 8}) {
+			SortedIndex index;
+			index.build(keys, threads);
+			agree &= index.range(0, std::numeric_limits<uint64_t>::max()) == scan(0, std::numeric_limits<uint64_t>::max());
+			for (uint32_t q = 0; q < 50 && agree; q++) {
+				uint64_t from = rng() % 600, to = rng() % 600;
+				if (q % 2) {
+					from = std::numeric_limits<uint64_t>::max() - from;
+					to = std::numeric_limits<uint64_t>::max() - to;
+				}
+				agree = index.range(from, to) == scan(from, to) && index.lookup(from) == scan(from, from);
+			}
+		}
+	}
+	if (!agree) {
+		std::cout << "MISMATCH in SortedIndex\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Checks GameDeduplicator against an exact set of (bowler, timestamp, rolls): a
+ *        stream full of resends and near-duplicates (one field or one trailing gutter
+ *        ball apart) on one thread, the same stream on 8 racing threads admitting each
+ *        game once, and a small capacity still rejecting an immediate resend
+ * @return false after printing the first disagreement
+ */
+bool checkGameDeduplicator() {
+	std::mt19937_64 rng(95);
+	struct Submission {
+		uint32_t bowler;
+		uint64_t timestamp;
+		std::vector<uint8_t> rolls;
+	};
+	std::vector<Submission> stream;
+	for (uint32_t s = 0; s < 100000; s++) {
+		if (!stream.empty() && rng() % 3 == 0) {
+			Submission again = stream[rng() % stream.size()];
+			switch (rng() % 4) {
+			case 0: again.bowler ^= 1; break;
+			case 1: again.timestamp++; break;
+			case 2:
+				if (nextRollLimit(again.rolls) >= 0) {
+					again.rolls.push_back(0);
+				}
+				break;
+			default: break; // Plain resend
+			}
+			stream.push_back(again);
+			continue;
+		}
+		Submission fresh {static_cast<uint32_t>(rng() % 100), rng() % 1000, {}};
+		for (int limit = PINS; limit >= 0 && (rng() % 8 || fresh.rolls.empty()); limit = nextRollLimit(fresh.rolls)) {
+			fresh.rolls.push_back(std::uniform_int_distribution<int>(0, limit)(rng));
+		}
+		stream.push_back(fresh);
+	}
+	auto branch = [](const Submission &submission) {
+		GameBranch game;
+		for (auto pins : submission.rolls) {
+			game.roll(pins);
+		}
+		return game;
+	};
+
+	GameDeduplicator serial(4 * stream.size()); // Room for every key, nothing forgotten
+	std::set<std::tuple<uint32_t, uint64_t, std::vector<uint8_t>>> seen;
+	bool agree = true;
+	for (const auto &submission : stream) {
+		bool fresh = seen.insert({submission.bowler, submission.timestamp, submission.rolls}).second;
+		agree &= serial.admit(submission.bowler, submission.timestamp, branch(submission)) == fresh;
+	}
+
+	GameDeduplicator shared(4 * stream.size());
+	std::atomic<size_t> admitted {0};
+	parallelFor(8, [&](unsigned t) {
+		for (size_t s = t; s < stream.size() + t; s++) { // Every thread submits the whole stream
+			const Submission &submission = stream[s % stream.size()];
+			admitted += shared.admit(submission.bowler, submission.timestamp, branch(submission));
+		}
+	});
+	agree &= admitted == seen.size();
+
+	GameDeduplicator small(GameDeduplicator::SHARDS);
+	for (const auto &submission : stream) {
+		GameBranch game = branch(submission);
+		small.admit(submission.bowler, submission.timestamp, game);
+		agree &= !small.admit(submission.bowler, submission.timestamp, game);
+	}
+	if (!agree) {
+		std::cout << "MISMATCH in GameDeduplicator\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Checks that admission sheds only the storming lane: under either storm every roll
+ *        of lanes 1 and up is accepted and raises the same alerts as without one, while
+ *        lane 0's junk is shed and a faulty pinsetter gets no more rolls through than its
+ *        roll budget allows
+ * @return false after printing the first disagreement
+ */
+bool checkRollAdmission() {
+	const GameCorpus corpus = benchmarkCorpora()[2].second;
+	const uint32_t rounds = 2 * MAX_ROLLS;
+	std::vector<std::pair<size_t, size_t>> quietAlerts;
+	for (Storm storm : {Storm::None, Storm::Stale, Storm::Faulty}) {
+		StandingQueries queries;
+		queries.add({{GameField::MaxPossible, Compare::Equal, MAX_SCORE}, {GameField::Frame, Compare::AtLeast, 6}});
+		queries.add({{GameField::StrikeStreak, Compare::AtLeast, 3}});
+		LaneTimeouts timeouts(queries, BENCH_IDLE_TICKS);
+		RollAdmission admission(timeouts, 1, BENCH_ROLLS_PER_TICK);
+		std::vector<RollEvent> arrivals;
+		std::vector<Alert> alerts;
+		std::vector<std::pair<size_t, size_t>> laneAlerts;
+		bool accepted = true;
+		for (uint32_t round = 0; round < rounds; round++) {
+			laneArrivals(arrivals, corpus, round, storm);
+			for (const RollEvent &event : arrivals) {
+				alerts.clear();
+				Admission outcome = admission.submit(event.lane, event.sequence, event.pins, round, alerts);
+				if (event.lane != 0) {
+					accepted &= outcome == Admission::Accepted;
+					for (const Alert &alert : alerts) {
+						laneAlerts.emplace_back(alert.lane, alert.query);
+					}
+				}
+			}
+			timeouts.tick([](size_t, int) {});
+		}
+		if (storm == Storm::None) {
+			quietAlerts = laneAlerts;
+		}
+		uint64_t shed = admission.count(0, Admission::Throttled);
+		uint64_t through = admission.count(0, Admission::Accepted) + admission.count(0, Admission::Invalid);
+		bool agree = accepted && !quietAlerts.empty() && laneAlerts == quietAlerts
+			&& (storm == Storm::None ? shed + through == 0 : shed > 0)
+			&& (storm != Storm::Faulty || through <= RollAdmission::ROLL_BURST + (rounds - 1) * BENCH_ROLLS_PER_TICK);
+		if (!agree) {
+			std::cout << "MISMATCH in RollAdmission under storm " << static_cast<int>(storm) << "\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Checks that sharding does not change what lanes see: the stand-in, with resends and
+ *        with games cut short so timeouts abandon them, gives the same center-wide totals on
+ *        1, 3 and 8 shards, and through blocking and spinning EventRings, as one unsharded
+ *        RollAdmission stack
+ * @return false after printing the first disagreement
+ */
+bool checkShardedLanes() {
+	const GameCorpus corpus = benchmarkCorpora()[3].second; // Pathological, many games cut short
+	const std::vector<std::vector<Condition>> queries {
+		{{GameField::MaxPossible, Compare::AtLeast, 200}, {GameField::Frame, Compare::AtLeast, 3}},
+		{{GameField::StrikeStreak, Compare::AtLeast, 2}},
+		{{GameField::SeriesTotal, Compare::AtLeast, 150}},
+	};
+	const size_t lanes = 200;
+	const uint32_t games = 4;
+
+	StandingQueries reference;
+	for (const auto &conditions : queries) {
+		reference.add(conditions);
+	}
+	LaneTimeouts timeouts(reference, BENCH_IDLE_TICKS);
+	RollAdmission admission(timeouts, 1, BENCH_ROLLS_PER_TICK);
+	LaneTotals expected;
+	std::vector<Alert> alerts;
+	auto submit = [&](size_t lane, uint32_t sequence, uint8_t pins, uint64_t now) {
+		alerts.clear();
+		expected.outcomes[static_cast<size_t>(admission.submit(lane, sequence, pins, now, alerts))]++;
+		expected.events++;
+		expected.alerts += alerts.size();
+	};
+	auto tick = [&] {
+		timeouts.tick([&](size_t, int score) {
+			expected.abandoned++;
+			expected.abandonedScore += score;
+		});
+	};
+	for (uint32_t round = 0; round < games * MAX_ROLLS; round++) {
+		uint32_t game = round / MAX_ROLLS, r = round % MAX_ROLLS;
+		for (size_t lane = 0; lane < lanes; lane++) {
+			const auto &rolls = corpus[(lane + game) % corpus.size()];
+			if (r < rolls.size()) {
+				submit(lane, round + 1, rolls[r], round);
+			}
+			if ((lane + round) % 7 == 0) {
+				submit(lane, round + 1, PINS, round);
+			}
+		}
+		tick();
+	}
+	for (uint64_t t = 0; t <= BENCH_IDLE_TICKS; t++) {
+		tick();
+	}
+
+	bool agree = expected.abandoned > 0 && expected.outcomes[static_cast<size_t>(Admission::Duplicate)] > 0;
+	std::vector<LaneTotals> totals;
+	for (unsigned shards : {1, 3, 8}) {
+		ShardedLanes center(shards, queries, BENCH_IDLE_TICKS, 1, BENCH_ROLLS_PER_TICK);
+		center.run([&](LaneShard &shard, unsigned index) {
+			bowlStandIn(shard, index, shards, lanes, corpus, games, true);
+		});
+		totals.push_back(center.totals());
+	}
+	for (auto mode : {PollMode::Blocking, PollMode::BusySpin}) { // The same events through rings
+		ShardedLanes center(3, queries, BENCH_IDLE_TICKS, 1, BENCH_ROLLS_PER_TICK);
+		std::vector<std::unique_ptr<EventRing>> rings;
+		for (unsigned s = 0; s < center.shards(); s++) {
+			rings.push_back(std::make_unique<EventRing>(mode));
+		}
+		std::thread producer([&] {
+			feedStandIn(rings, lanes, corpus, games, true, [](RollEvent &) {});
+		});
+		center.serve(rings, false, [](const RollEvent &) {});
+		producer.join();
+		center.run([&](LaneShard &shard, unsigned) {
+			while (shard.now() < games * MAX_ROLLS + BENCH_IDLE_TICKS + 1) {
+				shard.tick();
+			}
+		});
+		totals.push_back(center.totals());
+	}
+	for (const auto &found : totals) {
+		agree &= found.events == expected.events && found.alerts == expected.alerts
+			&& found.abandoned == expected.abandoned && found.abandonedScore == expected.abandonedScore
+			&& found.outcomes == expected.outcomes;
+	}
+	if (!agree) {
+		std::cout << "MISMATCH in ShardedLanes\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Checks every CRC32C path against the standard check value and, on random
+ *        unaligned buffers, the SSE4.2 path against the table
+ * @return false after printing the first disagreement
+ */
+bool checkCrc32c() {
+	const uint8_t check[] {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	bool agree = crc32cSoftware(check, sizeof(check)) == 0xE3069283 && crc32c(check, sizeof(check)) == 0xE3069283;
+#ifdef CRC32C_HARDWARE
+	if (__builtin_cpu_supports("sse4.2")) {
+		agree &= crc32cHardware(check, sizeof(check)) == 0xE3069283;
+		std::mt19937_64 rng(94);
+		std::vector<uint8_t> buffer(4096);
+		for (auto &byte : buffer) {
+			byte = rng();
+		}
+		for (uint32_t i = 0; i < 20000 && agree; i++) {
+			size_t offset = rng() % 64, size = rng() % (buffer.size() - offset);
+			agree = crc32cHardware(&buffer[offset], size) == crc32cSoftware(&buffer[offset], size);
+		}
+	}
+#endif
+	if (!agree) {
+		std::cout << "MISMATCH in CRC32C\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Checks a BowlerHistory round trip (timestamps, totals and marks counted straight
+ *        from the rolls), then that a block with one flipped bit is dropped and counted
+ * @return false after printing the first disagreement
+ */
+bool checkBowlerHistory() {
+	std::mt19937_64 rng(94);
+	BowlerHistory history;
+	std::vector<GameRecord> expected;
+	uint64_t timestamp = 0;
+	for (uint32_t g = 0; g < 10 * BowlerHistory::BLOCK_GAMES + 17; g++) {
+		std::vector<uint8_t> rolls;
+		GameBranch game;
+		GameRecord record {timestamp += rng() % 4 ? rng() % 1000 : rng() >> 20, 0, 0, 0};
+		bool freshRack = true;
+		for (int limit = PINS; limit >= 0; limit = nextRollLimit(rolls)) {
+			rolls.push_back(rng() % 3 == 0 ? limit : std::uniform_int_distribution<int>(0, limit)(rng));
+			game.roll(rolls.back());
+			if (rolls.back() == limit) { // Cleared the deck: a strike on a fresh rack, else a spare
+				(freshRack ? record.strikes : record.spares)++;
+			}
+			freshRack = rolls.back() == limit || !freshRack;
+		}
+		record.total = referenceScore(rolls);
+		history.append(record.timestamp, game);
+		expected.push_back(record);
+	}
+
+	auto same = [](const std::vector<GameRecord> &a, const std::vector<GameRecord> &b) {
+		return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const GameRecord &x, const GameRecord &y) {
+			return x.timestamp == y.timestamp && x.total == y.total && x.strikes == y.strikes && x.spares == y.spares;
+		});
+	};
+	size_t corrupt = 0;
+	bool agree = same(history.scan(0, timestamp, &corrupt), expected) && corrupt == 0;
+
+	const size_t block = 3;
+	history.m_blocks[block].bytes[rng() % history.m_blocks[block].bytes.size()] ^= 1 << rng() % 8;
+	expected.erase(expected.begin() + block * BowlerHistory::BLOCK_GAMES,
+	               expected.begin() + (block + 1) * BowlerHistory::BLOCK_GAMES);
+	agree &= same(history.scan(0, timestamp, &corrupt), expected) && corrupt == 1;
+	history.setVerifyChecksums(false);
+	agree &= history.scan(0, timestamp).size() == history.size();
+	if (!agree) {
+		std::cout << "MISMATCH in BowlerHistory\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Translates a FramePattern to a std::regex over one character per frame:
+ *        'a'-'j' open and 'k'-'t' spare by first ball, 'X' strike, 'E' end of game
+ */
+std::string frameRegex(const std::string &pattern) {
+	auto classChars = [](char c) -> std::string {
+		if (c >= '0' && c <= '9') {
+			return {static_cast<char>('a' + c - '0'), static_cast<char>('k' + c - '0')};
+		}
+		switch (c) {
+		case 'X': return "X";
+		case '/': return "k-t";
+		case 'O': return "a-j";
+		case '.': return "a-tX";
+		default: return "";
+		}
+	};
+	std::string regex;
+	for (size_t i = 0; i < pattern.size(); i++) {
+		char c = pattern[i];
+		if (c == '[') {
+			regex += '[';
+			while (pattern[++i] != ']') {
+				regex += classChars(pattern[i]);
+			}
+			regex += ']';
+		} else if (c == '$') {
+			regex += 'E';
+		} else if (std::string("^()|*+?").find(c) != std::string::npos) {
+			regex += c;
+		} else {
+			regex += "[" + classChars(c) + "]";
+		}
+	}
+	return regex;
+}
+
+/**
+ * @brief Cross-checks FramePattern against std::regex: for sampled games and a fixed pattern
+ *        set, the frames scan() reports a match ending on must be exactly the prefixes
+ *        the translated regex matches at their end
+ * @return false after printing the first disagreement
+ */
+bool checkFramePatterns() {
+	const std::vector<std::string> patterns {
+		"XXO", "^X", "X$", "/", "^XXXXXXXXX", "5", "(X/)+", "[O/]X", "^...(/X)+", "9$",
+		"X/X", "(XX|//)O?X", "^(O|/)+$", "X+O", "[01234]/", "^X?/", ".X.X", "^..........$",
+	};
+	ScoreSpace space;
+	GameColumns games, batch;
+	for (int target : {-1, 150, 200, 250, 280}) {
+		space.sampleBatch(batch, BENCH_PATTERN_GAMES, target, target + 1, std::thread::hardware_concurrency());
+		size_t offset = games.size();
+		games.rolls.insert(games.rolls.end(), batch.rolls.begin(), batch.rolls.end());
+		games.rollCounts.insert(games.rollCounts.end(), batch.rollCounts.begin(), batch.rollCounts.end());
+		games.totals.insert(games.totals.end(), batch.totals.begin(), batch.totals.end());
+		for (size_t g = offset; g < games.size(); g++) { // Cut some games short mid-frame
+			games.rollCounts[g] -= g % 3 == 0 ? std::min<size_t>(games.rollCounts[g], g % 7) : 0;
+		}
+	}
+
+	std::vector<std::string> frames(games.size());
+	for (size_t g = 0; g < games.size(); g++) {
+		const uint8_t *rolls = &games.rolls[g * MAX_ROLLS];
+		size_t count = games.rollCounts[g], i = 0;
+		for (uint8_t frame = 0; frame < FRAMES && i < count && (rolls[i] == PINS || i + 1 < count); frame++) {
+			bool strike = rolls[i] == PINS, spare = !strike && rolls[i] + rolls[i + 1] == BASE_SCORE;
+			frames[g] += strike ? 'X' : static_cast<char>((spare ? 'k' : 'a') + rolls[i]);
+			i += frame == FRAMES - 1 ? 2 + (strike || spare) : 2 - strike;
+		}
+		if (frames[g].size() == FRAMES && i == count) {
+			frames[g] += 'E';
+		}
+	}
+
+	for (const auto &pattern : patterns) {
+		FramePattern compiled;
+		compiled.compile(pattern);
+		std::regex regex("(" + frameRegex(pattern) + ")$");
+		std::vector<FrameMatch> matches = compiled.scan(games, std::thread::hardware_concurrency());
+		size_t m = 0;
+		for (size_t g = 0; g < games.size(); g++) {
+			std::vector<uint8_t> expected, found;
+			for (size_t end = 1; end <= frames[g].size(); end++) {
+				uint8_t frame = std::min<size_t>(end - 1, FRAMES - 1);
+				if (std::regex_search(frames[g].substr(0, end), regex) && (expected.empty() || expected.back() != frame)) {
+					expected.push_back(frame);
+				}
+			}
+			for (; m < matches.size() && matches[m].game == g; m++) {
+				found.push_back(matches[m].endFrame);
+			}
+			if (found != expected) {
+				std::cout << "MISMATCH for pattern " << pattern << " on frames " << frames[g] << "\n";
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Checks TimerWheel against a plain map of due ticks, with callbacks that cancel
+ *        timers due the same tick and arm new ones
+ * @return false after printing the first disagreement
+ */
+bool checkTimerWheel() {
+	TimerWheel wheel;
+	std::mt19937_64 rng(99);
+	std::vector<uint64_t> handles, due; // By payload; due tick, 0 once fired or cancelled
+	size_t live = 0, fired = 0;
+	bool agree = true;
+
+	auto arm = [&](uint64_t delay) {
+		handles.push_back(wheel.arm(delay, handles.size()));
+		due.push_back(wheel.now() + std::max<uint64_t>(delay, 1));
+		live++;
+	};
+	auto cancel = [&](uint64_t payload) {
+		bool armed = due[payload] != 0;
+		agree &= wheel.cancel(handles[payload]) == armed;
+		live -= armed;
+		due[payload] = 0;
+	};
+	auto fire = [&](uint64_t payload) {
+		agree &= due[payload] == wheel.now();
+		due[payload] = 0;
+		live--;
+		if (rng() % 2) { // Cancel a timer, often one due this very tick
+			cancel(rng() % handles.size());
+		}
+		if (rng() % 4 == 0) {
+			arm(rng() % 100);
+		}
+	};
+
+	// Two timers due the same tick: whichever fires first cancels the other
+	uint64_t first = wheel.arm(5, 0), second = wheel.arm(5, 1);
+	for (uint8_t t = 0; t < 5; t++) {
+		wheel.tick([&](uint64_t payload) {
+			fired++;
+			agree &= wheel.cancel(payload == 0 ? second : first);
+		});
+	}
+	agree &= fired == 1 && !wheel.cancel(first) && !wheel.cancel(second);
+
+	for (uint32_t step = 0; step < BENCH_TIMER_STEPS && agree; step++) {
+		arm(rng() % 4 ? rng() % 100 : rng() % (rng() % 1000 ? 100000 : 2 * TimerWheel::HORIZON));
+		if (rng() % 3 == 0) {
+			cancel(rng() % handles.size());
+		}
+		wheel.tick(fire);
+	}
+	while (live > 0 && agree) {
+		wheel.tick(fire);
+	}
+	if (!agree) {
+		std::cout << "MISMATCH in TimerWheel at tick " << wheel.now() << "\n";
+	}
+	return agree;
+}
+
+/**
+ * @brief Benchmark entry point
+ *        --save <file>       store the results as the new baseline
+ *        --compare <file>    fail if any path is slower than the baseline beyond the threshold,
+ *                            or if stale junk slows the other lanes beyond it
+ *        --threshold <pct>   allowed slowdown in percent, default 5
+ *        --verify <games>    instead of timing, differential check all engines on every
+ *                            legal prefix up to 7 rolls plus <games> random full games,
+ *                            then every check listed in `checks` against its model
+ */
+int benchmarkMain(int argc, char *argv[]) {
+	std::string saveFile, compareFile;
+	double threshold = 5.0;
+	uint64_t verifyGames = 0;
+	bool verify = false;
+	for (int i = 1; i < argc; i += 2) {
+		std::string option = argv[i];
+		if (i + 1 == argc) {
+			std::cerr << "Missing value for " << option << "\n";
+			return 2;
+		}
+		if (option == "--save") {
+			saveFile = argv[i + 1];
+		} else if (option == "--compare") {
+			compareFile = argv[i + 1];
+		} else if (option == "--threshold") {
+			threshold = std::atof(argv[i + 1]);
+		} else if (option == "--verify") {
+			verify = true;
+			verifyGames = std::strtoull(argv[i + 1], nullptr, 10);
+		} else {
+			std::cerr << "Unknown option " << option << "\n";
+			return 2;
+		}
+	}
+
+	if (verify) {
+		auto start = std::chrono::steady_clock::now();
+		uint64_t checked = runDifferentialCheck(7, verifyGames);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (checked > 0) {
+			std::cout << "All engines agree on " << checked << " games (" << checked / elapsed.count() / 1e6
+			          << " M games/s)\n";
+		}
+		const std::pair<const char *, bool (*)()> checks[] {
+			{"Boards agree with replays", checkBoards},
+			{"ScoreSpace agrees with brute force and samples evenly", checkScoreSpace},
+			{"StandingQueries agree with a rescoring model", checkStandingQueries},
+			{"groupScores agrees with sorted totals per key", checkGroupScores},
+			{"SimilarGames agrees with a full sort", checkSimilarGames},
+			{"SortedIndex agrees with a scan", checkSortedIndex},
+			{"GameDeduplicator agrees with an exact set", checkGameDeduplicator},
+			{"RollAdmission sheds only the storming lane", checkRollAdmission},
+			{"ShardedLanes agree with one unsharded stack", checkShardedLanes},
+			{"CRC32C agrees with the check value and the table", checkCrc32c},
+			{"BowlerHistory round-trips and drops a corrupted block", checkBowlerHistory},
+			{"FramePattern agrees with std::regex", checkFramePatterns},
+			{"TimerWheel agrees with its model", checkTimerWheel},
+		};
+		bool agree = checked > 0;
+		for (const auto &[message, check] : checks) {
+			if (check()) {
+				std::cout << message << "\n";
+			} else {
+				agree = false;
+			}
+		}
+		return agree ? 0 : 1;
+	}
+
+	std::map<std::string, BenchmarkResult> baseline;
+	if (!compareFile.empty()) {
+		std::ifstream in(compareFile);
+		std::string key;
+		BenchmarkResult result;
+		while (in >> key >> result.mean >> result.ci) {
+			baseline[key] = result;
+		}
+		if (baseline.empty()) {
+			std::cerr << "No baseline in " << compareFile << "\n";
+			return 2;
+		}
+	}
+
+	auto results = runBenchmarks();
+	int regressions = 0;
+	std::cout << std::fixed << std::setprecision(1);
+	for (const auto &[key, result] : results) {
+		std::cout << std::left << std::setw(44) << key << std::right << std::setw(10) << result.mean
+		          << " +/- " << std::setw(6) << result.ci << " " << result.unit;
+		auto base = baseline.find(key);
+		if (base != baseline.end()) {
+			double delta = 100.0 * (result.mean - base->second.mean) / base->second.mean;
+			// Regressed only if even the optimistic end of the new interval is beyond the tolerance
+			bool regressed = result.mean - result.ci > (base->second.mean + base->second.ci) * (1 + threshold / 100);
+			std::cout << "  " << std::showpos << delta << std::noshowpos << "%" << (regressed ? "  REGRESSION" : "");
+			regressions += regressed;
+		}
+		std::cout << "\n";
+	}
+	// Load shedding must keep the other lanes flat: stale junk may not slow them beyond the
+	// noise. A faulty pinsetter gets its roll budget through, so RollAdmission/faulty sits
+	// above quiet by design and is held to its own baseline only. Gated like the baseline,
+	// so a plain run only reports.
+	const BenchmarkResult &quiet = results.at("RollAdmission/quiet"), &storm = results.at("RollAdmission/stale");
+	bool flat = baseline.empty() || storm.mean - storm.ci <= (quiet.mean + quiet.ci) * (1 + threshold / 100);
+	if (!flat) {
+		std::cout << "RollAdmission/stale slower than RollAdmission/quiet  REGRESSION\n";
+	}
+
+	if (!saveFile.empty()) {
+		std::ofstream out(saveFile);
+		out << std::setprecision(3);
+		for (const auto &[key, result] : results) {
+			out << key << " " << result.mean << " " << result.ci << "\n";
+		}
+	}
+	return regressions == 0 && flat ? 0 : 1;
+}
+#endif
+
+
+#ifdef FUZZING
+/**
+ * @brief libFuzzer entry point: every input byte is a roll. The allocation-free GameBranch /
+ *        ScoreState path is checked against BowlingGame, whose storage is reused across inputs:
+ *        both must accept the same rolls, and calculateScore(), total() and GameBranch::total()
+ *        must agree.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+	static BowlingGame game;
+	game.clear();
+	GameBranch branch;
+	for (size_t i = 0; i < size; i++) {
+		if (branch.roll(data[i]) != game.roll(data[i])) {
+			__builtin_trap();
+		}
+	}
+	int totalScore = game.calculateScore();
+	if (totalScore != game.total() || totalScore != branch.total() || totalScore > MAX_SCORE
+	    || branch.state().maxPossible() < totalScore) {
+		__builtin_trap();
+	}
+	return 0;
+}
+#endif
+
+
+#if defined(BENCHMARK)
+int main(int argc, char *argv[]) {
+	return benchmarkMain(argc, argv);
+}
+#elif !defined(FUZZING)
+int main() {
+
+	BowlingGame game;
+#ifdef USER_DRIVEN
+	processUserInput(game);
+#else
+	std::vector<uint8_t> rolls {1, 4, 4, 5, 6, 4, 5, 5, 10, 0, 1, 7, 3, 6, 4, 10, 2, 8, 6};
+	for(auto r : rolls) {
+		game.roll(r);
+	}
+#endif
+	game.processFrames();
+	int totalSocre = game.calculateScore();
+	game.displayBoard();
+
+	std::cout << "Total score: " << totalSocre << std::endl;
+	return 0;
+}
+#endif
\ No newline at end of file